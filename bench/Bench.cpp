@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QThread>
+#include <chrono>
+#ifdef Q_OS_UNIX
+#include <ctime>
+#endif
+
+namespace {
+
+struct Benchmark
+{
+    QString name;
+    Bench::Setup setup;
+};
+
+struct Result
+{
+    QString name;
+    uint64_t operations;
+    double nsPerOperation;
+    // negative when the platform has no process cpu clock
+    double cpuNsPerOperation;
+};
+
+struct Timing
+{
+    double seconds;
+    double cpuSeconds;
+};
+
+QVector<Benchmark>& benchmarks()
+{
+    static QVector<Benchmark> list;
+    return list;
+}
+
+// cpu time used by all threads of the process, negative if unknown
+double processCpuSeconds()
+{
+#ifdef Q_OS_UNIX
+    timespec ts{};
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+        return -1.0;
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#else
+    return -1.0;
+#endif
+}
+
+Timing runTimed(const Bench::Runner& runner, uint64_t operations)
+{
+    const double cpuStart = processCpuSeconds();
+    const auto start = std::chrono::steady_clock::now();
+    runner(operations);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double cpuEnd = processCpuSeconds();
+    return {seconds, cpuStart < 0.0 || cpuEnd < 0.0 ? -1.0 : cpuEnd - cpuStart};
+}
+
+Result measure(const Benchmark& benchmark, double minSeconds, int repetitions)
+{
+    const auto runner = benchmark.setup();
+
+    // grow the count until one run is long enough for the clock resolution
+    uint64_t operations = 1;
+    Timing timing = runTimed(runner, operations);
+    while (timing.seconds < minSeconds && operations < (uint64_t{1} << 40))
+    {
+        const double scale =
+                timing.seconds > 0.0 ? qBound(2.0, minSeconds / timing.seconds * 1.2, 100.0) : 100.0;
+        operations = static_cast<uint64_t>(static_cast<double>(operations) * scale);
+        timing = runTimed(runner, operations);
+    }
+
+    // the cpu time is the one of the fastest run
+    for (int i = 1; i < repetitions; ++i)
+    {
+        const auto next = runTimed(runner, operations);
+        if (next.seconds < timing.seconds)
+            timing = next;
+    }
+
+    const double count = static_cast<double>(operations);
+    return {benchmark.name, operations, timing.seconds * 1e9 / count,
+            timing.cpuSeconds < 0.0 ? -1.0 : timing.cpuSeconds * 1e9 / count};
+}
+
+QJsonDocument toJson(const QVector<Result>& results)
+{
+    // same layout as google benchmark, so its compare tools work on it
+    QJsonObject context;
+    context[QStringLiteral("date")] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    context[QStringLiteral("host_name")] = QSysInfo::machineHostName();
+    context[QStringLiteral("num_cpus")] = QThread::idealThreadCount();
+    context[QStringLiteral("library_build_type")] = QStringLiteral(BENCH_BUILD_TYPE);
+
+    QJsonArray list;
+    for (const auto& result : results)
+    {
+        QJsonObject entry;
+        entry[QStringLiteral("name")] = result.name;
+        entry[QStringLiteral("run_type")] = QStringLiteral("iteration");
+        entry[QStringLiteral("iterations")] = static_cast<qint64>(result.operations);
+        entry[QStringLiteral("real_time")] = result.nsPerOperation;
+        if (result.cpuNsPerOperation >= 0.0)
+            entry[QStringLiteral("cpu_time")] = result.cpuNsPerOperation;
+        entry[QStringLiteral("time_unit")] = QStringLiteral("ns");
+        entry[QStringLiteral("items_per_second")] = 1e9 / result.nsPerOperation;
+        list.append(entry);
+    }
+
+    QJsonObject root;
+    root[QStringLiteral("context")] = context;
+    root[QStringLiteral("benchmarks")] = list;
+    return QJsonDocument{root};
+}
+
+} // namespace
+
+bool Bench::add(const QString& name, Setup setup)
+{
+    benchmarks().append({name, std::move(setup)});
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication::setApplicationName(QStringLiteral("6502emu-bench"));
+    QCoreApplication::setOrganizationName(QStringLiteral("volkarts.com"));
+
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Measures the emulation hot paths"));
+    parser.addHelpOption();
+    QCommandLineOption filterOption{{QStringLiteral("f"), QStringLiteral("filter")},
+                                    QStringLiteral("Only runs benchmarks matching the expression"),
+                                    QStringLiteral("regex")};
+    QCommandLineOption jsonOption{{QStringLiteral("j"), QStringLiteral("json")},
+                                  QStringLiteral("Writes the results as json, - for stdout"),
+                                  QStringLiteral("file")};
+    QCommandLineOption minTimeOption{QStringLiteral("min-time"),
+                                     QStringLiteral("Seconds every measured run takes at least"),
+                                     QStringLiteral("seconds"), QStringLiteral("0.2")};
+    QCommandLineOption repetitionsOption{QStringLiteral("repetitions"),
+                                         QStringLiteral("Runs per benchmark, the fastest counts"),
+                                         QStringLiteral("count"), QStringLiteral("3")};
+    QCommandLineOption listOption{QStringLiteral("list"), QStringLiteral("Lists the benchmarks")};
+    parser.addOptions({filterOption, jsonOption, minTimeOption, repetitionsOption, listOption});
+    parser.process(a);
+
+    const QRegularExpression filter{parser.value(filterOption)};
+    if (!filter.isValid())
+    {
+        qWarning() << "Invalid filter" << filter.errorString();
+        return 1;
+    }
+
+    const double minSeconds = qMax(parser.value(minTimeOption).toDouble(), 0.001);
+    const int repetitions = qMax(parser.value(repetitionsOption).toInt(), 1);
+    const bool jsonToStdout = parser.value(jsonOption) == QLatin1String("-");
+
+    QTextStream out{stdout};
+    QVector<Result> results;
+    for (const auto& benchmark : qAsConst(benchmarks()))
+    {
+        if (!filter.match(benchmark.name).hasMatch())
+            continue;
+
+        if (parser.isSet(listOption))
+        {
+            out << benchmark.name << '\n';
+            continue;
+        }
+
+        results.append(measure(benchmark, minSeconds, repetitions));
+
+        if (!jsonToStdout)
+        {
+            const auto& result = results.last();
+            out << qSetFieldWidth(40) << left << result.name << qSetFieldWidth(14) << right
+                << QString::number(result.nsPerOperation, 'f', 2) << qSetFieldWidth(0) << " ns/op"
+                << qSetFieldWidth(16) << result.operations << qSetFieldWidth(0) << " ops\n";
+            out.flush();
+        }
+    }
+
+    if (parser.isSet(jsonOption))
+    {
+        const auto json = toJson(results).toJson();
+        if (jsonToStdout)
+        {
+            out << json;
+        }
+        else
+        {
+            QFile file{parser.value(jsonOption)};
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+            {
+                qWarning() << "Could not write" << file.fileName();
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+#include <cinttypes>
+#include <functional>
+
+// Small benchmark harness. A benchmark's setup builds its state once and returns the runner,
+// which executes the measured operation the given number of times. The harness grows the
+// count until a run takes long enough and reports the fastest of several runs per operation.
+namespace Bench {
+
+using Runner = std::function<void(uint64_t operations)>;
+using Setup = std::function<Runner()>;
+
+// returns true, so benchmarks can register while initializing a static
+bool add(const QString& name, Setup setup);
+
+// keeps the compiler from dropping the computation of value
+template<typename T>
+inline void keep(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace Bench
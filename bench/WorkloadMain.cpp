@@ -0,0 +1,441 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BoardFile.h"
+#include "BoardPool.h"
+#include "board/ACIA.h"
+#include "board/Board.h"
+#include "board/Memory.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QThread>
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+constexpr int32_t ResetVector = 0xFFFC;
+
+struct Workload
+{
+    QString name;
+    QString boardFileName;
+    QString programFileName;
+    QString programMemory;
+    QString inputsFileName;
+    // bytes received by the board's first acia, the first one at serialStart and then one every
+    // serialInterval cycles, repeated until the run ends
+    QByteArray serialText;
+    uint64_t serialStart{};
+    uint64_t serialInterval{};
+    uint64_t cycles{};
+    // start address written over the program's reset vector, -1 keeps it
+    int32_t start{-1};
+    // skipped when the program is missing, for programs that can not be shipped with the corpus
+    bool optional{};
+};
+
+struct Measurement
+{
+    QString name;
+    uint64_t cycles{};
+    uint64_t nanoseconds{};
+    double peakRssKiB{};
+
+    double mhz() const { return static_cast<double>(cycles) * 1e3 / static_cast<double>(nanoseconds); }
+    double nsPerCycle() const { return static_cast<double>(nanoseconds) / static_cast<double>(cycles); }
+};
+
+bool loadManifest(const QString& fileName, QVector<Workload>& workloads)
+{
+    QFile file{fileName};
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Could not open manifest" << fileName;
+        return false;
+    }
+
+    QJsonParseError error{};
+    const auto document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (document.isNull())
+    {
+        qWarning() << "Invalid manifest" << fileName << error.errorString();
+        return false;
+    }
+
+    // paths are relative to the manifest
+    const QDir dir = QFileInfo{fileName}.dir();
+    const auto filePath = [&dir](const QJsonValue& value) {
+        return value.toString().isEmpty() ? QString{} : dir.filePath(value.toString());
+    };
+
+    for (const auto& value : document.object().value(QLatin1String("workloads")).toArray())
+    {
+        const auto entry = value.toObject();
+
+        Workload workload;
+        workload.name = entry.value(QLatin1String("name")).toString();
+        workload.boardFileName = filePath(entry.value(QLatin1String("board")));
+        workload.programFileName = filePath(entry.value(QLatin1String("program")));
+        workload.programMemory = entry.value(QLatin1String("memory")).toString(QStringLiteral("ROM"));
+        workload.inputsFileName = filePath(entry.value(QLatin1String("inputs")));
+        const auto serial = entry.value(QLatin1String("serial_input")).toObject();
+        workload.serialText = serial.value(QLatin1String("text")).toString().toLatin1();
+        workload.serialStart = static_cast<uint64_t>(serial.value(QLatin1String("start")).toDouble());
+        workload.serialInterval = static_cast<uint64_t>(serial.value(QLatin1String("interval")).toDouble());
+        workload.cycles = static_cast<uint64_t>(entry.value(QLatin1String("cycles")).toDouble());
+        workload.start = entry.value(QLatin1String("start")).toInt(-1);
+        workload.optional = entry.value(QLatin1String("optional")).toBool();
+
+        if (workload.name.isEmpty() || workload.boardFileName.isEmpty() || workload.cycles == 0 ||
+            (!workload.serialText.isEmpty() && (workload.serialInterval == 0 || !workload.inputsFileName.isEmpty())))
+        {
+            qWarning() << "Invalid workload" << workload.name << "in" << fileName;
+            return false;
+        }
+
+        workloads.append(workload);
+    }
+
+    return true;
+}
+
+bool serialInputs(const Workload& workload, const Board* board, QVector<InputLog::Input>& inputs)
+{
+    const auto& devices = board->devices();
+    const auto acia = std::find_if(devices.begin(), devices.end(),
+                                   [](const Device* device) { return qobject_cast<const ACIA*>(device); });
+    if (acia == devices.end())
+    {
+        qWarning() << "Workload" << workload.name << "has serial input, but the board has no ACIA";
+        return false;
+    }
+
+    const auto device = static_cast<int32_t>(acia - devices.begin());
+    int index = 0;
+    for (uint64_t cycle = workload.serialStart; cycle < workload.cycles; cycle += workload.serialInterval)
+    {
+        inputs.append({cycle, device, ACIA::SerialInput, static_cast<uint8_t>(workload.serialText.at(index))});
+        index = (index + 1) % workload.serialText.size();
+    }
+
+    return true;
+}
+
+double peakRssKiB()
+{
+#ifdef Q_OS_UNIX
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+#ifdef Q_OS_MACOS
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#else
+    return static_cast<double>(usage.ru_maxrss);
+#endif
+#else
+    return 0.0;
+#endif
+}
+
+// executed in a process of its own, so the peak rss belongs to this workload alone; prints the
+// measurement as one json line
+int runWorkload(const Workload& workload)
+{
+    BoardFile boardFile{workload.boardFileName};
+    if (!boardFile.loadSync())
+        return 1;
+
+    QVector<InputLog::Input> inputs;
+    if (!workload.inputsFileName.isEmpty())
+    {
+        QFile inputsFile{workload.inputsFileName};
+        if (!inputsFile.open(QIODevice::ReadOnly) || !InputLog::decode(inputsFile.readAll(), inputs))
+        {
+            qWarning() << "Could not read input log" << inputsFile.fileName();
+            return 1;
+        }
+    }
+
+    BoardJob job;
+    job.name = workload.name;
+    job.programFileName = workload.programFileName;
+    job.programMemory = workload.programMemory;
+    job.maxCycles = workload.cycles;
+    bool setupFailed = false;
+    job.setup = [&workload, &inputs, &setupFailed](Board* board) {
+        if (workload.start >= 0)
+        {
+            if (auto* memory = board->findDevice<Memory>(ResetVector))
+            {
+                const auto offset = ResetVector - memory->mapAddressStart();
+                memory->data()[offset] = static_cast<uint8_t>(workload.start);
+                memory->data()[offset + 1] = static_cast<uint8_t>(workload.start >> 8);
+            }
+        }
+
+        if (!workload.serialText.isEmpty() && !serialInputs(workload, board, inputs))
+            setupFailed = true;
+
+        if (!inputs.isEmpty())
+            board->inputLog().startReplay(inputs, board->cycleCount());
+    };
+
+    BoardPool pool{boardFile.boardInfo()};
+    pool.setMaxThreadCount(1);
+    const auto result = pool.run({job}).first();
+    if (result.exit == BoardResult::Exit::LoadFailed || setupFailed || result.cycles == 0)
+        return 1;
+
+    QJsonObject run;
+    run[QStringLiteral("cycles")] = static_cast<double>(result.cycles);
+    run[QStringLiteral("nanoseconds")] = static_cast<double>(qMax(result.nanoseconds, uint64_t{1}));
+    run[QStringLiteral("peak_rss_kib")] = peakRssKiB();
+    QTextStream{stdout} << QJsonDocument{run}.toJson(QJsonDocument::Compact) << '\n';
+
+    return 0;
+}
+
+bool measure(const QString& manifestFileName, const Workload& workload, int repetitions,
+             Measurement& measurement)
+{
+    measurement.name = workload.name;
+
+    for (int i = 0; i < repetitions; ++i)
+    {
+        QProcess process;
+        process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process.start(QCoreApplication::applicationFilePath(),
+                      {QStringLiteral("--run"), workload.name, manifestFileName});
+        if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit ||
+            process.exitCode() != 0)
+        {
+            qWarning() << "Workload" << workload.name << "failed";
+            return false;
+        }
+
+        const auto run = QJsonDocument::fromJson(process.readAllStandardOutput()).object();
+        const auto nanoseconds = static_cast<uint64_t>(run.value(QLatin1String("nanoseconds")).toDouble());
+        if (i == 0 || nanoseconds < measurement.nanoseconds)
+        {
+            measurement.cycles = static_cast<uint64_t>(run.value(QLatin1String("cycles")).toDouble());
+            measurement.nanoseconds = nanoseconds;
+        }
+        measurement.peakRssKiB = qMax(measurement.peakRssKiB, run.value(QLatin1String("peak_rss_kib")).toDouble());
+    }
+
+    return measurement.cycles > 0 && measurement.nanoseconds > 0;
+}
+
+QJsonDocument toJson(const QVector<Measurement>& measurements)
+{
+    QJsonObject context;
+    context[QStringLiteral("date")] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    context[QStringLiteral("host_name")] = QSysInfo::machineHostName();
+    context[QStringLiteral("num_cpus")] = QThread::idealThreadCount();
+    context[QStringLiteral("build_type")] = QStringLiteral(BENCH_BUILD_TYPE);
+
+    QJsonArray list;
+    for (const auto& measurement : measurements)
+    {
+        QJsonObject entry;
+        entry[QStringLiteral("name")] = measurement.name;
+        entry[QStringLiteral("cycles")] = static_cast<double>(measurement.cycles);
+        entry[QStringLiteral("mhz")] = measurement.mhz();
+        entry[QStringLiteral("ns_per_cycle")] = measurement.nsPerCycle();
+        entry[QStringLiteral("peak_rss_kib")] = measurement.peakRssKiB;
+        list.append(entry);
+    }
+
+    QJsonObject root;
+    root[QStringLiteral("context")] = context;
+    root[QStringLiteral("workloads")] = list;
+    return QJsonDocument{root};
+}
+
+bool loadBaseline(const QString& fileName, QHash<QString, double>& baseline)
+{
+    QFile file{fileName};
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Could not open baseline" << fileName;
+        return false;
+    }
+
+    const auto document = QJsonDocument::fromJson(file.readAll());
+    for (const auto& value : document.object().value(QLatin1String("workloads")).toArray())
+    {
+        const auto entry = value.toObject();
+        baseline.insert(entry.value(QLatin1String("name")).toString(), entry.value(QLatin1String("mhz")).toDouble());
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication::setApplicationName(QStringLiteral("6502emu-workloads"));
+    QCoreApplication::setOrganizationName(QStringLiteral("volkarts.com"));
+
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+            "Runs reference boards and programs end to end and reports the emulated speed, "
+            "exits with 2 when a workload is slower than the baseline allows"));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("manifest"), QStringLiteral("Workload manifest"),
+                                 QStringLiteral("[manifest]"));
+    QCommandLineOption filterOption{{QStringLiteral("f"), QStringLiteral("filter")},
+                                    QStringLiteral("Only runs workloads matching the expression"),
+                                    QStringLiteral("regex")};
+    QCommandLineOption jsonOption{{QStringLiteral("j"), QStringLiteral("json")},
+                                  QStringLiteral("Writes the results as json, - for stdout"),
+                                  QStringLiteral("file")};
+    QCommandLineOption baselineOption{{QStringLiteral("b"), QStringLiteral("baseline")},
+                                      QStringLiteral("Json results of an earlier run to compare against"),
+                                      QStringLiteral("file")};
+    QCommandLineOption thresholdOption{QStringLiteral("threshold"),
+                                       QStringLiteral("Slowdown against the baseline reported as regression"),
+                                       QStringLiteral("percent"), QStringLiteral("5")};
+    QCommandLineOption repetitionsOption{QStringLiteral("repetitions"),
+                                         QStringLiteral("Runs per workload, the fastest counts"),
+                                         QStringLiteral("count"), QStringLiteral("3")};
+    QCommandLineOption runOption{QStringLiteral("run"), QStringLiteral("Runs one workload in this process"),
+                                 QStringLiteral("name")};
+    runOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    parser.addOptions({filterOption, jsonOption, baselineOption, thresholdOption, repetitionsOption, runOption});
+    parser.process(a);
+
+    const QStringList arguments = parser.positionalArguments();
+    const QString manifestFileName = arguments.isEmpty() ? QStringLiteral(WORKLOADS_MANIFEST) : arguments.first();
+
+    QVector<Workload> workloads;
+    if (!loadManifest(manifestFileName, workloads))
+        return 1;
+
+    if (parser.isSet(runOption))
+    {
+        auto workload = std::find_if(workloads.begin(), workloads.end(),
+                                     [&parser, &runOption](const auto& w) { return w.name == parser.value(runOption); });
+        if (workload == workloads.end())
+        {
+            qWarning() << "No such workload" << parser.value(runOption);
+            return 1;
+        }
+
+        return runWorkload(*workload);
+    }
+
+    const QRegularExpression filter{parser.value(filterOption)};
+    if (!filter.isValid())
+    {
+        qWarning() << "Invalid filter" << filter.errorString();
+        return 1;
+    }
+
+    QHash<QString, double> baseline;
+    if (parser.isSet(baselineOption) && !loadBaseline(parser.value(baselineOption), baseline))
+        return 1;
+
+    const double threshold = parser.value(thresholdOption).toDouble();
+    const int repetitions = qMax(parser.value(repetitionsOption).toInt(), 1);
+    const bool jsonToStdout = parser.value(jsonOption) == QLatin1String("-");
+
+    int exitCode = 0;
+    QTextStream out{stdout};
+    QVector<Measurement> measurements;
+    for (const auto& workload : qAsConst(workloads))
+    {
+        if (!filter.match(workload.name).hasMatch())
+            continue;
+
+        if (workload.optional && !QFileInfo::exists(workload.programFileName))
+        {
+            if (!jsonToStdout)
+                out << qSetFieldWidth(24) << left << workload.name << qSetFieldWidth(0) << "skipped, no "
+                    << QFileInfo{workload.programFileName}.fileName() << '\n';
+            continue;
+        }
+
+        Measurement measurement;
+        if (!measure(manifestFileName, workload, repetitions, measurement))
+        {
+            exitCode = 1;
+            continue;
+        }
+        measurements.append(measurement);
+
+        QString comparison;
+        const double baselineMhz = baseline.value(workload.name);
+        if (baselineMhz > 0.0)
+        {
+            const double change = (measurement.mhz() / baselineMhz - 1.0) * 100.0;
+            comparison = QStringLiteral("%1%2%").arg(change >= 0.0 ? QStringLiteral("+") : QString{})
+                                 .arg(change, 0, 'f', 1);
+            if (change < -threshold)
+            {
+                comparison += QStringLiteral(" REGRESSION");
+                if (exitCode == 0)
+                    exitCode = 2;
+            }
+        }
+
+        if (!jsonToStdout)
+        {
+            out << qSetFieldWidth(24) << left << measurement.name << qSetFieldWidth(10) << right
+                << QString::number(measurement.mhz(), 'f', 2) << qSetFieldWidth(0) << " MHz"
+                << qSetFieldWidth(10) << QString::number(measurement.nsPerCycle(), 'f', 2)
+                << qSetFieldWidth(0) << " ns/cycle" << qSetFieldWidth(10)
+                << QString::number(measurement.peakRssKiB / 1024.0, 'f', 1) << qSetFieldWidth(0)
+                << " MiB rss  " << comparison << '\n';
+            out.flush();
+        }
+    }
+
+    if (parser.isSet(jsonOption))
+    {
+        const auto json = toJson(measurements).toJson();
+        if (jsonToStdout)
+        {
+            out << json;
+        }
+        else
+        {
+            QFile file{parser.value(jsonOption)};
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+            {
+                qWarning() << "Could not write" << file.fileName();
+                return 1;
+            }
+        }
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include "utils/BitMapping.h"
+#include "utils/Bits.h"
+
+namespace {
+
+// masks as found in board files, a port on the low bus bits and one spread over a wider bus
+constexpr uint64_t PortMask = 0xFF;
+constexpr uint64_t ContiguousBusMask = 0xFF00;
+constexpr uint64_t ScatteredBusMask = 0x5A5A;
+
+[[maybe_unused]] const bool bitsRegistered =
+    Bench::add(QStringLiteral("extract_inject_bits"), []() -> Bench::Runner {
+        return [](uint64_t operations) {
+            uint64_t value = 0;
+            for (uint64_t i = 0; i < operations; ++i)
+            {
+                const auto port = extractBits(i, ContiguousBusMask);
+                value ^= injectBits(value, ContiguousBusMask, port);
+                Bench::keep(value);
+            }
+        };
+    }) &&
+    Bench::add(QStringLiteral("bit_mapping/contiguous"), []() -> Bench::Runner {
+        return [mapping = BitMapping{ContiguousBusMask, PortMask}](uint64_t operations) {
+            for (uint64_t i = 0; i < operations; ++i)
+                Bench::keep(mapping.map(i));
+        };
+    }) &&
+    Bench::add(QStringLiteral("bit_mapping/scattered"), []() -> Bench::Runner {
+        return [mapping = BitMapping{ScatteredBusMask, PortMask}](uint64_t operations) {
+            for (uint64_t i = 0; i < operations; ++i)
+                Bench::keep(mapping.map(i));
+        };
+    }) &&
+    Bench::add(QStringLiteral("bit_mapping_tables/scattered"), []() -> Bench::Runner {
+        return [mapping = BitMapping{ScatteredBusMask, PortMask}](uint64_t operations) {
+            for (uint64_t i = 0; i < operations; ++i)
+                Bench::keep(mapping.mapTables(i));
+        };
+    });
+
+} // namespace
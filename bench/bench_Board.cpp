@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include "board/Board.h"
+#include "board/Bus.h"
+#include "board/Clock.h"
+#include "board/LCD.h"
+#include "board/Memory.h"
+#include "board/VIA.h"
+#include <memory>
+#include <type_traits>
+
+namespace {
+
+// RAM at 0x0000, ROM at 0x8000 running a store loop and the given number of VIAs from 0x6000 on
+std::shared_ptr<Board> createBoard(int vias)
+{
+    auto board = std::make_shared<Board>();
+
+    QVector<Device*> devices;
+    for (int i = 0; i < vias; ++i)
+    {
+        auto* via = new VIA{QStringLiteral("VIA%1").arg(i), board.get()};
+        via->setMapAddressStart(0x6000 + i * 0x10);
+        devices.append(via);
+    }
+
+    auto* ram = new Memory{Memory::Type::RAM, 0x8000, QStringLiteral("RAM"), board.get()};
+    ram->setMapAddressStart(0x0000);
+    auto* rom = new Memory{Memory::Type::ROM, 0x8000, QStringLiteral("ROM"), board.get()};
+    rom->setMapAddressStart(0x8000);
+    devices << ram << rom;
+
+    const QVector<uint8_t> program{
+        0xA2, 0x00,       // ldx #$00
+        0x8A,             // txa
+        0x9D, 0x00, 0x02, // sta $0200,x
+        0xE8,             // inx
+        0x4C, 0x02, 0x80, // jmp $8002
+    };
+    std::copy(program.cbegin(), program.cend(), rom->data().begin());
+    rom->data()[0x7FFC] = 0x00;
+    rom->data()[0x7FFD] = 0x80;
+
+    board->reset(devices, {});
+    return board;
+}
+
+[[maybe_unused]] const bool boardRegistered = []() {
+    for (const int vias : {0, 1, 4, 16})
+    {
+        // the single edge path taken by the clock timer at low frequencies
+        Bench::add(QStringLiteral("board_clock_edge/%1_vias").arg(vias), [vias]() -> Bench::Runner {
+            auto board = createBoard(vias);
+            return [board](uint64_t operations) {
+                for (uint64_t i = 0; i < operations; ++i)
+                {
+                    board->clock()->triggerEdge(StateEdge::Falling);
+                    board->clock()->triggerEdge(StateEdge::Raising);
+                }
+            };
+        });
+
+        // whole cycles as run by the cycle runner and the batch runner
+        for (const bool stepping : {false, true})
+        {
+            const auto name = QStringLiteral("board_run%1/%2_vias").arg(stepping ? QStringLiteral("_stepping") : QString{})
+                                                                  .arg(vias);
+            Bench::add(name, [vias, stepping]() -> Bench::Runner {
+                auto board = createBoard(vias);
+                board->setInstructionStepping(stepping);
+                return [board](uint64_t operations) { board->run(operations); };
+            });
+        }
+    }
+    return true;
+}();
+
+[[maybe_unused]] const bool memoryRegistered = Bench::add(QStringLiteral("memory_clock_edge"), []() -> Bench::Runner {
+    auto board = std::make_shared<Board>();
+    auto* ram = new Memory{Memory::Type::RAM, 0x8000, QStringLiteral("RAM"), board.get()};
+    board->reset({ram}, {});
+    board->setRwLine(WireState::High);
+    ram->setSelected(true);
+
+    return [board, ram](uint64_t operations) {
+        for (uint64_t i = 0; i < operations; ++i)
+        {
+            board->addressBus()->setData(i & 0x7FFF);
+            ram->clockEdge(StateEdge::Falling);
+            ram->clockEdge(StateEdge::Raising);
+        }
+        Bench::keep(board->dataBus()->data());
+    };
+});
+
+template<typename T>
+Bench::Setup deviceTicking(bool observed)
+{
+    return [observed]() -> Bench::Runner {
+        auto board = std::make_shared<Board>();
+        auto* device = new T{QStringLiteral("DEVICE"), board.get()};
+        auto* bus = new Bus{QStringLiteral("PORT"), 16, board.get()};
+        device->addBusConnection(QString::fromLatin1(std::is_same_v<T, VIA> ? "PA" : "DATA"), 0xFF, bus, 0xFF);
+        board->reset({device}, {bus});
+
+        if constexpr (std::is_same_v<T, VIA>)
+        {
+            // an observed via emits its timer changes on every tick
+            if (observed)
+                QObject::connect(device, &VIA::t1Changed, device, []() {});
+        }
+        else
+        {
+            Q_UNUSED(observed)
+        }
+
+        return [board, device](uint64_t operations) {
+            for (uint64_t i = 0; i < operations; ++i)
+            {
+                device->clockEdge(StateEdge::Falling);
+                device->clockEdge(StateEdge::Raising);
+            }
+        };
+    };
+}
+
+[[maybe_unused]] const bool devicesRegistered =
+    Bench::add(QStringLiteral("via_clock_edge"), deviceTicking<VIA>(false)) &&
+    Bench::add(QStringLiteral("via_clock_edge/observed"), deviceTicking<VIA>(true)) &&
+    Bench::add(QStringLiteral("lcd_clock_edge"), deviceTicking<LCD>(false));
+
+} // namespace
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include "board/Board.h"
+#include "board/Memory.h"
+#include "impl/m6502.h"
+#include "M6502Disassembler.h"
+#include <QVector>
+#include <memory>
+
+namespace {
+
+// a loop of common instructions at 0x0200, the reset vector points to it
+const QVector<uint8_t> Program{
+    0xA9, 0x10,       // lda #$10
+    0x85, 0x20,       // sta $20
+    0xA2, 0x08,       // ldx #$08
+    0xE6, 0x20,       // inc $20
+    0xB5, 0x18,       // lda $18,x
+    0x9D, 0x00, 0x03, // sta $0300,x
+    0xCA,             // dex
+    0xD0, 0xF6,       // bne $0206
+    0x20, 0x16, 0x02, // jsr $0216
+    0x4C, 0x00, 0x02, // jmp $0200
+    0x60,             // rts
+};
+
+struct Core
+{
+    m6502_t cpu{};
+    uint64_t pins{};
+    uint8_t memory[0x10000]{};
+};
+
+[[maybe_unused]] const bool tickRegistered = Bench::add(QStringLiteral("m6502_tick"), []() -> Bench::Runner {
+    auto core = std::make_shared<Core>();
+    std::copy(Program.cbegin(), Program.cend(), core->memory + 0x0200);
+    core->memory[0xFFFC] = 0x00;
+    core->memory[0xFFFD] = 0x02;
+
+    m6502_desc_t desc{};
+    core->pins = m6502_init(&core->cpu, &desc);
+
+    return [core](uint64_t operations) {
+        uint64_t pins = core->pins;
+        for (uint64_t i = 0; i < operations; ++i)
+        {
+            pins = m6502_tick(&core->cpu, pins);
+            const uint16_t address = M6502_GET_ADDR(pins);
+            if (pins & M6502_RW)
+            {
+                M6502_SET_DATA(pins, core->memory[address]);
+            }
+            else
+            {
+                core->memory[address] = M6502_GET_DATA(pins);
+            }
+        }
+        core->pins = pins;
+        Bench::keep(pins);
+    };
+});
+
+[[maybe_unused]] const bool disassembleRegistered = Bench::add(QStringLiteral("disassemble_count/100"), []() -> Bench::Runner {
+    auto board = std::make_shared<Board>();
+    auto* rom = new Memory{Memory::Type::ROM, 0x1000, QStringLiteral("ROM"), board.get()};
+    for (int32_t i = 0; i < rom->size(); ++i)
+        rom->data()[i] = Program.at(i % Program.size());
+    board->reset({rom}, {});
+
+    return [board, rom](uint64_t operations) {
+        for (uint64_t i = 0; i < operations; ++i)
+            Bench::keep(M6502::disassembleCount(rom, 100).size());
+    };
+});
+
+} // namespace
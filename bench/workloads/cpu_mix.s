@@ -0,0 +1,75 @@
+; cpu bound instruction mix: fills a page with a pseudo random sequence, sums it and
+; runs one bubble sort pass over it, forever
+
+seed = $00
+sum = $01
+count = $02
+buffer = $0200
+
+    org $8000
+
+reset:
+    ldx #$ff
+    txs
+    cld
+    lda #$01
+    sta seed
+    lda #$00
+    sta count
+    sta count+1
+
+loop:
+    ldy #$00
+    lda seed
+fill:
+    asl a
+    bcc nofeedback
+    eor #$1d
+nofeedback:
+    sta buffer,y
+    iny
+    bne fill
+    sta seed
+
+    ldy #$00
+    tya
+    clc
+checksum:
+    adc buffer,y
+    iny
+    bne checksum
+    sta sum
+
+    ldy #$00
+pass:
+    lda buffer,y
+    cmp buffer+1,y
+    bcc ordered
+    tax
+    lda buffer+1,y
+    sta buffer,y
+    txa
+    sta buffer+1,y
+ordered:
+    iny
+    cpy #$ff
+    bne pass
+
+    jsr countloop
+    jmp loop
+
+countloop:
+    inc count
+    bne counted
+    inc count+1
+counted:
+    rts
+
+nmi:
+irq:
+    rti
+
+    org $fffa
+    word nmi
+    word reset
+    word irq
@@ -0,0 +1,121 @@
+; display traffic: drives a hd44780 through port b (data) and port a (rs, rw, e) of a
+; 6522 and scrolls a text across both lines without polling the busy flag
+
+VIA_ORB = $6000
+VIA_ORA = $6001
+VIA_DDRB = $6002
+VIA_DDRA = $6003
+
+LCD_RS = %001
+LCD_RW = %010
+LCD_E = %100
+
+frame = $00
+
+    org $8000
+
+reset:
+    ldx #$ff
+    txs
+    cld
+    lda #$ff
+    sta VIA_DDRB
+    lda #LCD_RS|LCD_RW|LCD_E
+    sta VIA_DDRA
+    lda #$00
+    sta VIA_ORA
+    sta frame
+    jsr longdelay
+
+    lda #$38                ; 8 bit, 2 lines, 5x8 font
+    jsr command
+    lda #$0c                ; display on, cursor off
+    jsr command
+    lda #$06                ; increment, no shift
+    jsr command
+    lda #$01                ; clear display
+    jsr command
+    jsr longdelay
+
+    ldx #$00
+print:
+    lda message,x
+    beq scroll
+    jsr data
+    inx
+    jmp print
+
+scroll:
+    lda #$18                ; shift display left
+    jsr command
+    lda #$c0                ; second line
+    jsr command
+    ldx frame
+    ldy #$10
+line:
+    txa
+    and #$1f
+    tax
+    lda message,x
+    bne visible
+    lda #' '
+visible:
+    jsr data
+    inx
+    dey
+    bne line
+    inc frame
+    jsr longdelay
+    jmp scroll
+
+command:
+    sta VIA_ORB
+    lda #$00
+    sta VIA_ORA
+    lda #LCD_E
+    sta VIA_ORA
+    lda #$00
+    sta VIA_ORA
+    jmp shortdelay
+
+data:
+    sta VIA_ORB
+    lda #LCD_RS
+    sta VIA_ORA
+    lda #LCD_RS|LCD_E
+    sta VIA_ORA
+    lda #LCD_RS
+    sta VIA_ORA
+
+shortdelay:
+    pha
+    lda #$08
+waitshort:
+    sec
+    sbc #$01
+    bne waitshort
+    pla
+    rts
+
+longdelay:
+    pha
+    lda #$10
+waitlong:
+    jsr shortdelay
+    sec
+    sbc #$01
+    bne waitlong
+    pla
+    rts
+
+message:
+    byte "6502emu workload scrolling text",0
+
+nmi:
+irq:
+    rti
+
+    org $fffa
+    word nmi
+    word reset
+    word irq
@@ -0,0 +1,51 @@
+; serial traffic: echoes every byte received by a 6551 at 19200 baud, 8n1, polling the
+; receiver and waiting one frame after each send because of the transmitter empty bug
+
+ACIA_DATA = $5000
+ACIA_STATUS = $5001
+ACIA_COMMAND = $5002
+ACIA_CONTROL = $5003
+
+RECEIVER_FULL = %00001000
+
+received = $00
+
+    org $8000
+
+reset:
+    ldx #$ff
+    txs
+    cld
+    lda #$00
+    sta received
+    sta received+1
+    sta ACIA_STATUS         ; programmed reset
+    lda #$1f                ; 8n1, 19200 baud
+    sta ACIA_CONTROL
+    lda #$0b                ; no parity, no echo, no interrupts, dtr
+    sta ACIA_COMMAND
+
+receive:
+    lda ACIA_STATUS
+    and #RECEIVER_FULL
+    beq receive
+    lda ACIA_DATA
+    sta ACIA_DATA
+    inc received
+    bne sent
+    inc received+1
+sent:
+    ldx #$70                ; one frame, 560 cycles at 1 mhz
+wait:
+    dex
+    bne wait
+    jmp receive
+
+nmi:
+irq:
+    rti
+
+    org $fffa
+    word nmi
+    word reset
+    word irq
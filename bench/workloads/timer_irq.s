@@ -0,0 +1,62 @@
+; interrupt load: timer 1 of a 6522 runs free with a period of 100 cycles and the handler
+; counts the interrupts while the main loop keeps a second counter busy
+
+VIA_T1CL = $6004
+VIA_T1CH = $6005
+VIA_ACR = $600b
+VIA_IFR = $600d
+VIA_IER = $600e
+
+PERIOD = 100
+
+ticks = $00
+work = $02
+
+    org $8000
+
+reset:
+    ldx #$ff
+    txs
+    cld
+    sei
+    lda #$00
+    sta ticks
+    sta ticks+1
+    sta work
+    sta work+1
+
+    lda #$40                ; timer 1 free running, pb7 disabled
+    sta VIA_ACR
+    lda #$7f                ; disable all interrupts
+    sta VIA_IER
+    lda #$c0                ; enable timer 1 interrupt
+    sta VIA_IER
+    lda #<PERIOD
+    sta VIA_T1CL
+    lda #>PERIOD
+    sta VIA_T1CH
+    cli
+
+loop:
+    inc work
+    bne loop
+    inc work+1
+    jmp loop
+
+irq:
+    pha
+    lda VIA_T1CL            ; acknowledge timer 1
+    inc ticks
+    bne handled
+    inc ticks+1
+handled:
+    pla
+    rti
+
+nmi:
+    rti
+
+    org $fffa
+    word nmi
+    word reset
+    word irq
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BoardFile.h"
+#include "BoardPool.h"
+#include "ProgramLoader.h"
+#include "board/Board.h"
+#include "board/Coverage.h"
+#include "board/Debugger.h"
+#ifdef STATIC_BOARD
+#include "board/StaticBoard.h"
+#endif
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <vector>
+
+namespace {
+
+const char* exitName(BoardResult::Exit exit)
+{
+    switch (exit)
+    {
+        case BoardResult::Exit::LoadFailed:
+            return "load-failed";
+        case BoardResult::Exit::CycleLimit:
+            return "cycle-limit";
+        case BoardResult::Exit::Condition:
+            return "condition";
+        case BoardResult::Exit::Stopped:
+            return "stopped";
+    }
+
+    return "";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication::setApplicationName(QStringLiteral("6502emu-batch"));
+    QCoreApplication::setOrganizationName(QStringLiteral("volkarts.com"));
+
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Runs many boards in parallel without a gui"));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("board"), QStringLiteral("Board file"));
+    parser.addPositionalArgument(QStringLiteral("programs"), QStringLiteral("Programs, one run each"),
+                                 QStringLiteral("[programs...]"));
+    QCommandLineOption memoryOption{{QStringLiteral("m"), QStringLiteral("memory")},
+                                    QStringLiteral("Memory device the programs are loaded into"),
+                                    QStringLiteral("name"), QStringLiteral("ROM")};
+    QCommandLineOption cyclesOption{{QStringLiteral("c"), QStringLiteral("cycles")},
+                                    QStringLiteral("Cycles to run every board"),
+                                    QStringLiteral("cycles"), QStringLiteral("1000000")};
+    QCommandLineOption countOption{{QStringLiteral("n"), QStringLiteral("count")},
+                                   QStringLiteral("Runs per program"),
+                                   QStringLiteral("count"), QStringLiteral("1")};
+    QCommandLineOption threadsOption{{QStringLiteral("j"), QStringLiteral("threads")},
+                                     QStringLiteral("Worker threads, defaults to the number of cores"),
+                                     QStringLiteral("threads")};
+    QCommandLineOption inputsOption{{QStringLiteral("i"), QStringLiteral("inputs")},
+                                    QStringLiteral("Input log replayed in every run"),
+                                    QStringLiteral("file")};
+    QCommandLineOption profileOption{{QStringLiteral("p"), QStringLiteral("profile")},
+                                     QStringLiteral("Writes the folded call stacks of every run into the directory, "
+                                                    "for flamegraph tools"),
+                                     QStringLiteral("directory")};
+    QCommandLineOption coverageOption{QStringLiteral("coverage"),
+                                      QStringLiteral("Writes the coverage of every run of a listing into the "
+                                                     "directory, as lcov .info and Cobertura .xml"),
+                                      QStringLiteral("directory")};
+    QCommandLineOption minCoverageOption{QStringLiteral("min-coverage"),
+                                         QStringLiteral("Fails with exit code 2 when a run of a listing covers less "
+                                                        "of its source lines"),
+                                         QStringLiteral("percent")};
+    parser.addOptions({memoryOption, cyclesOption, countOption, threadsOption, inputsOption, profileOption,
+                       coverageOption, minCoverageOption});
+    parser.process(a);
+
+    QStringList arguments = parser.positionalArguments();
+    if (arguments.isEmpty())
+        parser.showHelp(1);
+
+    BoardFile boardFile{arguments.takeFirst()};
+    if (!boardFile.loadSync())
+        return 1;
+
+    if (arguments.isEmpty())
+        arguments.append(QString{});
+
+    QVector<InputLog::Input> inputs;
+    if (parser.isSet(inputsOption))
+    {
+        QFile inputsFile{parser.value(inputsOption)};
+        if (!inputsFile.open(QIODevice::ReadOnly) || !InputLog::decode(inputsFile.readAll(), inputs))
+        {
+            qWarning() << "Could not read input log" << inputsFile.fileName();
+            return 1;
+        }
+    }
+
+    const uint64_t cycles = parser.value(cyclesOption).toULongLong();
+    const int count = qMax(parser.value(countOption).toInt(), 1);
+
+    const bool profiling = parser.isSet(profileOption);
+    const QDir profileDir{parser.value(profileOption)};
+    const bool covering = parser.isSet(coverageOption) || parser.isSet(minCoverageOption);
+    const bool writingCoverage = parser.isSet(coverageOption);
+    const QDir coverageDir{parser.value(coverageOption)};
+    for (const auto* dirOption : {&profileOption, &coverageOption})
+    {
+        if (parser.isSet(*dirOption) && !QDir{parser.value(*dirOption)}.mkpath(QStringLiteral(".")))
+        {
+            qWarning() << "Could not create directory" << parser.value(*dirOption);
+            return 1;
+        }
+    }
+
+    // line coverage per job in percent, written by the pool threads
+    std::vector<double> lineCoverage(static_cast<size_t>(arguments.size() * count), 100.0);
+
+    QVector<BoardJob> jobs;
+    for (const auto& program : qAsConst(arguments))
+    {
+        QList<Program::SourceLine> sourceLines;
+        if ((profiling || covering) && !program.isEmpty())
+            sourceLines = ProgramLoader{}.loadProgram(program).sourceLines();
+
+        // frames are named by the labels of listings, which sit next to their sources
+        const auto symbols = Profiler::symbols(sourceLines);
+        const QFileInfo programInfo{program};
+        const auto sourceFileName = programInfo.dir().filePath(programInfo.completeBaseName() + QStringLiteral(".s"));
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto baseName = QStringLiteral("%1-%2").arg(programInfo.completeBaseName()).arg(i);
+            const auto jobIndex = static_cast<size_t>(jobs.size());
+
+            BoardJob job;
+            job.name = QStringLiteral("%1#%2").arg(program).arg(i);
+            job.programFileName = program;
+            job.programMemory = parser.value(memoryOption);
+            job.maxCycles = cycles;
+            job.setup = [inputs, profiling, covering](Board* board) {
+#ifdef STATIC_BOARD
+                board->setDispatch(createStaticDispatch());
+#endif
+                if (!inputs.isEmpty())
+                    board->inputLog().startReplay(inputs, board->cycleCount());
+
+                board->debugger()->profiler().setEnabled(profiling);
+                board->debugger()->coverage().setEnabled(covering);
+            };
+            if (profiling || covering)
+            {
+                job.finished = [=, &lineCoverage](Board* board) {
+                    const auto write = [](const QString& fileName, const QByteArray& data) {
+                        QFile file{fileName};
+                        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(data) != data.size())
+                            qWarning() << "Could not write" << fileName;
+                    };
+
+                    if (profiling)
+                    {
+                        write(profileDir.filePath(baseName + QStringLiteral(".folded")),
+                              board->debugger()->profiler().profile().foldedStacks(symbols));
+                    }
+
+                    if (!covering || sourceLines.isEmpty())
+                        return;
+
+                    const auto& coverage = board->debugger()->coverage();
+                    const auto summary = Coverage::summarize(coverage.lines(sourceLines));
+                    if (summary.lines > 0)
+                        lineCoverage[jobIndex] = summary.coveredLines * 100.0 / summary.lines;
+
+                    if (writingCoverage)
+                    {
+                        write(coverageDir.filePath(baseName + QStringLiteral(".info")),
+                              coverage.toLcov(sourceLines, sourceFileName));
+                        write(coverageDir.filePath(baseName + QStringLiteral(".xml")),
+                              coverage.toCobertura(sourceLines, sourceFileName));
+                    }
+                };
+            }
+            jobs.append(job);
+        }
+    }
+
+    BoardPool pool{boardFile.boardInfo()};
+    if (parser.isSet(threadsOption))
+        pool.setMaxThreadCount(parser.value(threadsOption).toInt());
+
+    const auto results = pool.run(jobs);
+
+    int exitCode = 0;
+    QTextStream out{stdout};
+    for (const auto& result : results)
+    {
+        if (result.exit == BoardResult::Exit::LoadFailed)
+            exitCode = 1;
+
+        out << result.name << '\t' << exitName(result.exit) << '\t' << result.cycles << '\t'
+            << QString::fromLatin1(result.serialOutput.toPercentEncoding(" ")) << '\n';
+    }
+
+    if (parser.isSet(minCoverageOption))
+    {
+        const double minCoverage = parser.value(minCoverageOption).toDouble();
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const auto coverage = lineCoverage[static_cast<size_t>(i)];
+            if (coverage >= minCoverage)
+                continue;
+
+            qWarning().noquote() << QStringLiteral("Line coverage of %1 is %2%, below %3%")
+                                    .arg(results[i].name).arg(coverage, 0, 'f', 1).arg(minCoverage);
+            if (exitCode == 0)
+                exitCode = 2;
+        }
+    }
+
+    return exitCode;
+}
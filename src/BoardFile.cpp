@@ -125,7 +125,9 @@ struct glz::meta<AciaInfo>
                 "type", &T::type,
                 "name", &T::name,
                 "address", &T::address,
-                "connections", &T::connections
+                "connections", &T::connections,
+                "crystal_frequency", &T::crystalFrequency,
+                "clock_frequency", &T::clockFrequency
                 );
 };
 
@@ -167,40 +169,47 @@ BoardFile::BoardFile(QString fileName, QObject* parent) :
 void BoardFile::load()
 {
     QThreadPool::globalInstance()->start([this]() -> void {
-        bool result = false;
+        bool result = loadImpl();
+
+        emit loaded(result);
+    });
+}
+
+bool BoardFile::loadSync()
+{
+    return loadImpl();
+}
 
-        if (QFile input{fileName_}; !input.open(QFile::ReadOnly))
+bool BoardFile::loadImpl()
+{
+    if (QFile input{fileName_}; !input.open(QFile::ReadOnly))
+    {
+        qWarning() << "Could not open file" << fileName_;
+        return false;
+    }
+    else
+    {
+        QByteArray jsonData = input.readAll();
+        if (jsonData.isEmpty())
         {
-            qWarning() << "Could not open file" << fileName_;
+            qWarning() << "Failed to load from input" ;
+            return false;
         }
-        else
+
+        std::string_view bufferView{
+            jsonData.constData(), static_cast<std::string_view::size_type>(jsonData.length())};
+        BoardInfo boardInfo{};
+        auto ec = glz::read_json(boardInfo, bufferView);
+        if (ec)
         {
-            QByteArray jsonData = input.readAll();
-            if (jsonData.isEmpty())
-            {
-                qWarning() << "Failed to load from input" ;
-            }
-            else
-            {
-                std::string_view bufferView{
-                    jsonData.constData(), static_cast<std::string_view::size_type>(jsonData.length())};
-                BoardInfo boardInfo{};
-                auto ec = glz::read_json(boardInfo, bufferView);
-                if (ec)
-                {
-                    qWarning() << "Failed to parse input json:" <<
-                                  QString::fromStdString(glz::format_error(ec, bufferView));
-                }
-                else
-                {
-                    boardInfo_ = boardInfo;
-                    result = true;
-                }
-            }
+            qWarning() << "Failed to parse input json:" <<
+                          QString::fromStdString(glz::format_error(ec, bufferView));
+            return false;
         }
 
-        emit loaded(result);
-    });
+        boardInfo_ = boardInfo;
+        return true;
+    }
 }
 
 void BoardFile::save()
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "board/ACIA.h"
 #include "board/Memory.h"
 #include <QObject>
 #include <QSharedPointer>
@@ -63,6 +64,8 @@ struct ViaInfo : DeviceCommonInfo
 
 struct AciaInfo : DeviceCommonInfo
 {
+    double crystalFrequency{ACIA::DefaultCrystalFrequency};
+    double clockFrequency{ACIA::DefaultClockFrequency};
 };
 
 struct LcdInfo : DeviceCommonInfo
@@ -106,12 +109,17 @@ public:
     const BoardInfo& boardInfo() const { return boardInfo_; }
 
     void load();
+    // loads on the calling thread
+    bool loadSync();
     void save();
 
 signals:
     void loaded(bool result);
     void saved(bool result);
 
+private:
+    bool loadImpl();
+
 private:
     QString fileName_;
     BoardInfo boardInfo_;
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "board/Board.h"
+#include "board/Device.h"
+#include "BoardFile.h"
+#include "BoardLoader.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+namespace {
+
+QString hexAddress(int32_t address)
+{
+    if (address < 0)
+        return QString::number(address);
+    return QStringLiteral("0x%1").arg(QString::number(address, 16).toUpper().rightJustified(4, QLatin1Char('0')));
+}
+
+QString generate(const QString& boardFileName, const Board& board)
+{
+    QString source;
+    QTextStream out{&source};
+
+    QStringList types;
+    for (const auto* device : board.devices())
+    {
+        const auto type = QString::fromLatin1(device->metaObject()->className());
+        if (!types.contains(type))
+            types.append(type);
+    }
+    types.sort();
+
+    out << "// generated by 6502emu-boardgen from " << QFileInfo{boardFileName}.fileName() << ", do not edit\n\n";
+    for (const auto& type : qAsConst(types))
+        out << "#include \"board/" << type << ".h\"\n";
+    out << "#include \"board/StaticBoard.h\"\n\n";
+
+    out << "BoardDispatch* createStaticDispatch()\n{\n";
+    out << "    return new StaticBoard<\n";
+    const auto& devices = board.devices();
+    for (int i = 0; i < devices.size(); ++i)
+    {
+        const auto* device = devices[i];
+        out << "        StaticDevice<" << device->metaObject()->className() << ", "
+            << hexAddress(device->mapAddressStart()) << ", " << hexAddress(device->mapAddressEnd()) << ", "
+            << (device->needsClockTick() ? "true" : "false") << ">" << (i + 1 < devices.size() ? "," : "")
+            << " // " << device->name() << "\n";
+    }
+    out << "    >{};\n}\n";
+
+    return source;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication::setApplicationName(QStringLiteral("6502emu-boardgen"));
+    QCoreApplication::setOrganizationName(QStringLiteral("volkarts.com"));
+
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Writes the static device dispatch of a board as C++ source"));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("board"), QStringLiteral("Board file"));
+    parser.addPositionalArgument(QStringLiteral("output"), QStringLiteral("Source file to write"));
+    parser.process(a);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 2)
+        parser.showHelp(1);
+
+    BoardFile boardFile{arguments.at(0)};
+    if (!boardFile.loadSync())
+        return 1;
+
+    Board board;
+    BoardLoader loader{boardFile.boardInfo()};
+    if (!loader.loadSync(&board))
+        return 1;
+
+    const auto source = generate(boardFile.fileName(), board).toUtf8();
+
+    QFile output{arguments.at(1)};
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate) || output.write(source) != source.size())
+    {
+        qWarning() << "Could not write" << output.fileName();
+        return 1;
+    }
+
+    return 0;
+}
@@ -24,13 +24,14 @@
 #include <QDebug>
 #include <QIODevice>
 #include <QThreadPool>
+#include <atomic>
 #include <optional>
 
 namespace {
 
 auto createBusses(const BoardInfo& boardInfo, Board* board)
 {
-    static int busAutoNameIndex{0};
+    static std::atomic_int busAutoNameIndex{0};
 
     QVector<Bus*> busses;
 
@@ -112,7 +113,7 @@ void saveBusConnections(DeviceInfo& deviceInfo, const Device* device)
 
 Device* createDevice(const DeviceInfo& deviceInfo, Board* board)
 {
-    static int deviceAutoNameIndex{0};
+    static std::atomic_int deviceAutoNameIndex{0};
 
     auto baseInfo = deviceCommon(deviceInfo);
 
@@ -143,8 +144,10 @@ Device* createDevice(const DeviceInfo& deviceInfo, Board* board)
         case DeviceType::ACIA:
         {
             const auto& aciaInfo = std::get<AciaInfo>(deviceInfo);
-            Q_UNUSED(aciaInfo)
-            device = new ACIA(deviceName, board);
+            auto* acia = new ACIA(deviceName, board);
+            acia->setCrystalFrequency(aciaInfo.crystalFrequency);
+            acia->setClockFrequency(aciaInfo.clockFrequency);
+            device = acia;
             break;
         }
 
@@ -185,9 +188,8 @@ std::optional<DeviceInfo> saveDevice(const Device* device)
     }
     else if (const auto* acia = qobject_cast<const ACIA*>(device))
     {
-        Q_UNUSED(acia)
         commonInfo.type = DeviceType::ACIA;
-        deviceInfo = AciaInfo{commonInfo};
+        deviceInfo = AciaInfo{commonInfo, acia->crystalFrequency(), acia->clockFrequency()};
     }
     else if (const auto* lcd = qobject_cast<const LCD*>(device))
     {
@@ -279,6 +281,11 @@ void BoardLoader::load(Board* board)
     });
 }
 
+bool BoardLoader::loadSync(Board* board)
+{
+    return loadImpl(boardInfo_, board);
+}
+
 bool BoardLoader::loadImpl(const BoardInfo& boardInfo, Board* board)
 {
     auto bussesResult = createBusses(boardInfo, board);
@@ -26,6 +26,8 @@ public:
     BoardLoader(BoardInfo& boardInfo, QObject* parent = {});
 
     void load(Board* board);
+    // loads on the calling thread, used when the board is owned by that thread
+    bool loadSync(Board* board);
     void save(const Board* board);
 
 signals:
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BoardPool.h"
+
+#include "board/ACIA.h"
+#include "board/Board.h"
+#include "board/Clock.h"
+#include "board/Memory.h"
+#include "BoardLoader.h"
+#include "Program.h"
+#include "ProgramLoader.h"
+#include "utils/ArrayView.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+
+bool loadProgram(Board* board, const BoardJob& job)
+{
+    auto memory = std::find_if(board->devices().begin(), board->devices().end(),
+                               [&job](const auto* d) { return d->name() == job.programMemory; });
+    auto* programMemory = memory != board->devices().end() ? qobject_cast<Memory*>(*memory) : nullptr;
+    if (!programMemory)
+    {
+        qWarning() << "No such memory" << job.programMemory;
+        return false;
+    }
+
+    ProgramLoader loader;
+    Program program = loader.loadProgram(job.programFileName);
+    if (program.isNull())
+        return false;
+
+    const QByteArray& data = program.binaryData();
+    const int size = qMin(data.size(), programMemory->size());
+    programMemory->setData(0, ArrayView{reinterpret_cast<const uint8_t*>(data.constData()), size});
+
+    return true;
+}
+
+} // namespace
+
+BoardPool::BoardPool(BoardInfo boardInfo, QObject* parent) :
+    QObject{parent},
+    boardInfo_{std::move(boardInfo)},
+    maxThreadCount_{QThread::idealThreadCount()}
+{
+}
+
+BoardPool::~BoardPool()
+{
+}
+
+void BoardPool::setMaxThreadCount(int maxThreadCount)
+{
+    maxThreadCount_ = qMax(maxThreadCount, 1);
+}
+
+QVector<BoardResult> BoardPool::run(const QVector<BoardJob>& jobs)
+{
+    QVector<BoardResult> results(jobs.size());
+
+    // a private pool, so long runs do not starve the file loaders on the global one; idle
+    // threads pick the next queued job, every job writes only its own result slot
+    QThreadPool pool;
+    pool.setMaxThreadCount(maxThreadCount_);
+
+    for (int i = 0; i < jobs.size(); ++i)
+    {
+        pool.start([this, &jobs, &results, i]() -> void {
+            results[i] = runJob(jobs.at(i));
+            emit jobFinished(i);
+        });
+    }
+
+    pool.waitForDone();
+
+    return results;
+}
+
+BoardResult BoardPool::runJob(const BoardJob& job)
+{
+    BoardResult result;
+    result.name = job.name;
+
+    Board board;
+
+    BoardLoader loader{boardInfo_};
+    if (!loader.loadSync(&board))
+        return result;
+
+    if (!job.programFileName.isEmpty() && !loadProgram(&board, job))
+        return result;
+
+    for (auto* device : board.devices())
+    {
+        if (auto* acia = qobject_cast<ACIA*>(device))
+        {
+            connect(acia, &ACIA::sendByte, acia, [&result](uint8_t byte) {
+                result.serialOutput.append(static_cast<char>(byte));
+            }, Qt::DirectConnection);
+        }
+    }
+
+    if (job.setup)
+        job.setup(&board);
+
+    board.setInstructionStepping(job.instructionStepping);
+
+    bool conditionMet = false;
+    std::function<bool()> predicate;
+    if (job.stopCondition)
+    {
+        predicate = [&job, &board, &conditionMet]() {
+            conditionMet = job.stopCondition(&board);
+            return conditionMet;
+        };
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    result.cycles = board.runUntil(predicate, job.maxCycles);
+    result.nanoseconds = static_cast<uint64_t>(timer.nsecsElapsed());
+
+    if (job.finished)
+        job.finished(&board);
+
+    if (conditionMet)
+        result.exit = BoardResult::Exit::Condition;
+    else if (result.cycles < job.maxCycles)
+        result.exit = BoardResult::Exit::Stopped;
+    else
+        result.exit = BoardResult::Exit::CycleLimit;
+
+    return result;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "BoardFile.h"
+#include <QObject>
+#include <functional>
+
+class Board;
+
+struct BoardJob
+{
+    QString name{};
+    // optional, loaded into the memory device called programMemory before the run
+    QString programFileName{};
+    QString programMemory{};
+    uint64_t maxCycles{};
+    bool instructionStepping{true};
+    // all optional, called on the worker thread that owns the board; finished right after the run
+    std::function<void(Board*)> setup{};
+    std::function<bool(const Board*)> stopCondition{};
+    std::function<void(Board*)> finished{};
+};
+
+struct BoardResult
+{
+    enum class Exit
+    {
+        LoadFailed,
+        CycleLimit,
+        Condition,
+        Stopped,
+    };
+
+    QString name{};
+    Exit exit{Exit::LoadFailed};
+    uint64_t cycles{};
+    // host time of the run itself, without building the board and loading the program
+    uint64_t nanoseconds{};
+    QByteArray serialOutput{};
+};
+
+// runs independent boards built from one board description on all cores, every board lives
+// on the pool thread executing its job and is driven without the clock timer
+class BoardPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BoardPool(BoardInfo boardInfo, QObject* parent = {});
+    ~BoardPool() override;
+
+    int maxThreadCount() const { return maxThreadCount_; }
+    void setMaxThreadCount(int maxThreadCount);
+
+    // blocks until all jobs are done, the results are in job order
+    QVector<BoardResult> run(const QVector<BoardJob>& jobs);
+
+signals:
+    // emitted from the pool threads
+    void jobFinished(int index);
+
+private:
+    BoardResult runJob(const BoardJob& job);
+
+private:
+    BoardInfo boardInfo_;
+    int maxThreadCount_;
+
+    Q_DISABLE_COPY_MOVE(BoardPool)
+};
@@ -37,3 +37,14 @@ void SignalProxy::trigger()
 }
 
 } // namespace internal
+
+void LooseSignal::releaseWithReceiver(QObject* receiver, const QMetaObject::Connection& connection,
+                                      internal::SignalProxy* signalProxy)
+{
+    // disconnecting is thread safe and takes effect right away, the proxy itself is deleted in
+    // the sender's thread and the deletion is dropped when the sender went first
+    QObject::connect(receiver, &QObject::destroyed, [connection]() {
+        QObject::disconnect(connection);
+    });
+    QObject::connect(receiver, &QObject::destroyed, signalProxy, &QObject::deleteLater);
+}
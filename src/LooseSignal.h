@@ -93,12 +93,19 @@ public:
         auto* signalProxy = new internal::SignalProxy(sender);
         auto* slotProxy = new internal::SlotProxy(receiver, std::forward<Func2>(slot));
 
-        QObject::connect(sender, std::forward<Func1>(signal),
-                         signalProxy, &internal::SignalProxy::trigger, Qt::DirectConnection);
+        auto connection = QObject::connect(sender, std::forward<Func1>(signal),
+                                           signalProxy, &internal::SignalProxy::trigger, Qt::DirectConnection);
         QObject::connect(signalProxy, &internal::SignalProxy::action,
                          slotProxy, &internal::SlotProxy::onAction, Qt::QueuedConnection);
+
+        releaseWithReceiver(receiver, connection, signalProxy);
     }
 
 private:
     LooseSignal() = delete;
+
+    // the signal proxy lives as long as the sender, so the sender would keep seeing a connected
+    // signal after the receiver is gone
+    static void releaseWithReceiver(QObject* receiver, const QMetaObject::Connection& connection,
+                                    internal::SignalProxy* signalProxy);
 };
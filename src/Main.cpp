@@ -15,6 +15,9 @@
 #include "MainWindow.h"
 #include "board/Board.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QFile>
 #include <QThread>
 
 int main(int argc, char* argv[])
@@ -26,12 +29,38 @@ int main(int argc, char* argv[])
 
     QApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption recordInputsOption{QStringLiteral("record-inputs"),
+                                          QStringLiteral("Records the inputs since the last board load into a file "
+                                                         "for replaying with 6502emu-batch"),
+                                          QStringLiteral("file")};
+    parser.addOption(recordInputsOption);
+    parser.process(a);
+
     auto* board = new Board{};
+    board->setHistoryEnabled(true);
+    if (parser.isSet(recordInputsOption))
+        board->inputLog().startRecording(board->cycleCount());
 
     BoardExecutor boardExecutor{board};
 
     MainWindow mainWindow{board};
     mainWindow.show();
 
-    return QApplication::exec();
+    const auto result = QApplication::exec();
+
+    if (parser.isSet(recordInputsOption))
+    {
+        QByteArray inputLog;
+        QMetaObject::invokeMethod(board, [board, &inputLog]() {
+            inputLog = InputLog::encode(board->inputLog().inputs());
+        }, Qt::BlockingQueuedConnection);
+
+        QFile file{parser.value(recordInputsOption)};
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(inputLog) != inputLog.size())
+            qWarning() << "Could not write input log" << file.fileName();
+    }
+
+    return result;
 }
@@ -108,6 +108,9 @@ void MainWindow::setup()
 
     connect(ui->stepInstructionButton, &QPushButton::clicked, board_->debugger(), &Debugger::stepInstruction);
     connect(ui->stepSubroutineButton, &QPushButton::clicked, board_->debugger(), &Debugger::stepSubroutine);
+    connect(ui->reverseStepInstructionButton, &QPushButton::clicked,
+            board_->debugger(), &Debugger::reverseStepInstruction);
+    connect(ui->reverseContinueButton, &QPushButton::clicked, board_->debugger(), &Debugger::reverseContinue);
 
     connect(board_->clock(), &Clock::runningChanged, this, &MainWindow::onClockRunningChanged);
     connect(board_->clock(), &Clock::statsUpdatedClockCycles, this, &MainWindow::onStatsUpdatedClockCycles);
@@ -227,6 +230,14 @@ void MainWindow::createBoardMenu()
     ui->actionDisassemblyLog->setData(
                 QVariant::fromValue(DisassemblerViewFactory::create(tr("Disassembly log"))));
     connect(ui->actionDisassemblyLog, &QAction::triggered, this, &MainWindow::onBoardViewAction);
+
+    ui->actionTimingStats->setEnabled(false);
+    ui->actionTimingStats->setData(QVariant::fromValue(TimingViewFactory::create(tr("Timing stats"))));
+    connect(ui->actionTimingStats, &QAction::triggered, this, &MainWindow::onBoardViewAction);
+
+    ui->actionProfiler->setEnabled(false);
+    ui->actionProfiler->setData(QVariant::fromValue(ProfilerViewFactory::create(tr("Profiler"))));
+    connect(ui->actionProfiler, &QAction::triggered, this, &MainWindow::onBoardViewAction);
 }
 
 void MainWindow::loadedBoardChanged()
@@ -292,6 +303,20 @@ void MainWindow::rebuildBoardMenuActions()
         ui->actionDisassemblyLog->setChecked(show);
     }
 
+    {
+        auto viewFactory = extractViewFactory(ui->actionTimingStats);
+        Q_ASSERT(viewFactory);
+        auto show = userState_->viewVisible(viewFactory->viewName(), false);
+        ui->actionTimingStats->setChecked(show);
+    }
+
+    {
+        auto viewFactory = extractViewFactory(ui->actionProfiler);
+        Q_ASSERT(viewFactory);
+        auto show = userState_->viewVisible(viewFactory->viewName(), false);
+        ui->actionProfiler->setChecked(show);
+    }
+
     ui->actionNoDevices->setVisible(devices.isEmpty());
 }
 
@@ -379,6 +404,8 @@ void MainWindow::onClockRunningChanged()
 {
     ui->stepInstructionButton->setEnabled(!board_->clock()->isRunning());
     ui->stepSubroutineButton->setEnabled(!board_->clock()->isRunning());
+    ui->reverseStepInstructionButton->setEnabled(!board_->clock()->isRunning());
+    ui->reverseContinueButton->setEnabled(!board_->clock()->isRunning());
 }
 
 void MainWindow::onBoardViewAction()
@@ -400,12 +427,14 @@ void MainWindow::onBoardResetted()
     showEnabledViews();
 
     ui->actionDisassemblyLog->setEnabled(true);
+    ui->actionTimingStats->setEnabled(true);
+    ui->actionProfiler->setEnabled(true);
     ui->centralwidget->setEnabled(true);
 }
 
-void MainWindow::onStatsUpdatedClockCycles(uint32_t clockCycles)
+void MainWindow::onStatsUpdatedClockCycles(uint32_t clockCycles, uint32_t jitter)
 {
-    const QString message = tr("Running at %1Hz").arg(humanReadable(clockCycles));
+    const QString message = tr("Running at %1Hz, jitter %2ns").arg(humanReadable(clockCycles)).arg(jitter);
     statusMessage_->setText(message);
 }
 
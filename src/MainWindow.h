@@ -48,7 +48,7 @@ private slots:
     void onClockRunningChanged();
     void onBoardViewAction();
     void onBoardResetted();
-    void onStatsUpdatedClockCycles(uint32_t clockCycles);
+    void onStatsUpdatedClockCycles(uint32_t clockCycles, uint32_t jitter);
     void onActionManageBoardTriggered();
     void onActionNewBoardTriggered();
     void onActionOpenBoardTriggered();
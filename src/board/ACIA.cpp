@@ -15,7 +15,9 @@
 
 #include "Board.h"
 #include "Bus.h"
-#include <QTimer>
+#include <QDataStream>
+#include <QDebug>
+#include <cmath>
 
 namespace {
 
@@ -37,23 +39,31 @@ enum Command : uint8_t
     ParityMode_NI = 0x00,
 };
 
-constexpr std::array BaudTimeMap = {
-    9,
-    20000,
-    13333,
-    9174,
-    7463,
-    6667,
-    3333,
-    1667,
-    833,
-    556,
-    417,
-    278,
-    208,
-    139,
-    104,
-    52
+enum Control : uint8_t
+{
+    WordLength = 0x60,
+    TwoStopBits = 0x80,
+};
+
+// divides the 16x baud clock from the crystal, 0 selects the external 16x clock which is
+// taken to run at crystal speed
+constexpr std::array BaudDivisors = {
+    1,
+    2304, // 50
+    1536, // 75
+    1048, // 109.92
+    856,  // 134.58
+    768,  // 150
+    384,  // 300
+    192,  // 600
+    96,   // 1200
+    64,   // 1800
+    48,   // 2400
+    32,   // 3600
+    24,   // 4800
+    16,   // 7200
+    12,   // 9600
+    6     // 19200
 };
 
 inline constexpr uint8_t baudRateConfig(uint8_t reg)
@@ -64,17 +74,10 @@ inline constexpr uint8_t baudRateConfig(uint8_t reg)
 } // namespace
 
 ACIA::ACIA(const QString& name, Board* board) :
-    Device{name, board},
-    transmitDelay_{new QTimer{this}},
-    receiveDelay_{new QTimer{this}}
+    Device{name, board}
 {
     receiveBuffer_.reserve(1024);
 
-    transmitDelay_->setSingleShot(true);
-    connect(transmitDelay_, &QTimer::timeout, this, &ACIA::transmitDelayTimeout);
-    receiveDelay_->setSingleShot(true);
-    connect(receiveDelay_, &QTimer::timeout, this, &ACIA::receiveDelayTimeout);
-
     resetChip(true);
 }
 
@@ -89,17 +92,43 @@ uint8_t ACIA::baudRate() const
 
 bool ACIA::isTransmitting() const
 {
-    return transmitDelay_->isActive();
+    return transmitDoneCycle_ != NoEvent;
 }
 
 bool ACIA::isReceiving() const
 {
-    return receiveDelay_->isActive();
+    return receiveDoneCycle_ != NoEvent;
+}
+
+void ACIA::setCrystalFrequency(double frequency)
+{
+    if (frequency <= 0.0)
+    {
+        qWarning() << "Invalid ACIA crystal frequency" << frequency;
+        return;
+    }
+
+    crystalFrequency_ = frequency;
+}
+
+void ACIA::setClockFrequency(double frequency)
+{
+    if (frequency <= 0.0)
+    {
+        qWarning() << "Invalid ACIA clock frequency" << frequency;
+        return;
+    }
+
+    clockFrequency_ = frequency;
 }
 
-void ACIA::setBaudDelayFactor(int factor)
+uint64_t ACIA::nextEventCycle() const
 {
-    baudDelayFactor_ = factor;
+    // registers only change when selected, a pending interrupt is driven every edge
+    if (statusRegister_ & IRQ)
+        return board()->cycleCount();
+
+    return qMin(transmitDoneCycle_, receiveDoneCycle_);
 }
 
 void ACIA::receiveByte(uint8_t byte)
@@ -110,6 +139,12 @@ void ACIA::receiveByte(uint8_t byte)
     emit receivingChanged();
 }
 
+void ACIA::applyInput(uint8_t channel, uint32_t value)
+{
+    if (channel == SerialInput)
+        receiveByte(static_cast<uint8_t>(value));
+}
+
 int32_t ACIA::calcMapAddressEnd() const
 {
     return mapAddressStart_ + 0x03;
@@ -117,23 +152,47 @@ int32_t ACIA::calcMapAddressEnd() const
 
 void ACIA::deviceClockEdge(StateEdge edge)
 {
-    if (isLow(board()->resetLine()))
+    const uint32_t lines = board()->controlLines();
+
+    if (!(lines & Board::ResetLine))
     {
         resetChip(true);
         return;
     }
 
+    finishTransfers();
+
     if (isRaising(edge) && isSelected())
     {
-        if (isLow(board()->rwLine()))
+        if (!(lines & Board::RwLine))
             injectState();
-        else // if (isHigh(board()->rwLine()))
+        else
             populateState();
     }
 
     populateGlobalState();
 }
 
+void ACIA::saveState(QDataStream& stream) const
+{
+    stream << receiveBuffer_ << controlRegister_ << commandRegister_ << transmitData_ << receiveData_
+           << statusRegister_ << static_cast<quint64>(transmitDoneCycle_) << static_cast<quint64>(receiveDoneCycle_);
+}
+
+void ACIA::restoreState(QDataStream& stream)
+{
+    quint64 transmitDoneCycle{};
+    quint64 receiveDoneCycle{};
+    stream >> receiveBuffer_ >> controlRegister_ >> commandRegister_ >> transmitData_ >> receiveData_
+           >> statusRegister_ >> transmitDoneCycle >> receiveDoneCycle;
+    transmitDoneCycle_ = transmitDoneCycle;
+    receiveDoneCycle_ = receiveDoneCycle;
+
+    emit registerChanged();
+    emit transmittingChanged();
+    emit receivingChanged();
+}
+
 void ACIA::resetChip(bool hard)
 {
     if (hard)
@@ -212,26 +271,47 @@ void ACIA::populateState()
 void ACIA::populateGlobalState()
 {
     if (statusRegister_ & IRQ)
-        board()->setIrqLine(WireState::Low);
+        board()->setControlLines(0, Board::IrqLine);
 }
 
 void ACIA::startTransmit()
 {
-    transmitDelay_->start(baudDelay());
+    transmitDoneCycle_ = board()->cycleCount() + frameCycles();
+    wake();
 }
 
 void ACIA::startReceive()
 {
-    receiveDelay_->start(baudDelay());
+    receiveDoneCycle_ = board()->cycleCount() + frameCycles();
+    wake();
+}
+
+uint64_t ACIA::frameCycles() const
+{
+    // start bit, data bits, parity bit and stop bits
+    const auto dataBits = 8 - ((controlRegister_ & WordLength) >> 5);
+    const auto frameBits = 1 + dataBits + ((commandRegister_ & ParityEnabled) ? 1 : 0) +
+            ((controlRegister_ & TwoStopBits) ? 2 : 1);
+
+    const auto bitCycles = clockFrequency_ * 16.0 * BaudDivisors.at(baudRate()) / crystalFrequency_;
+    return std::max(uint64_t{1}, static_cast<uint64_t>(std::llround(bitCycles * frameBits)));
 }
 
-int ACIA::baudDelay()
+void ACIA::finishTransfers()
 {
-    return BaudTimeMap.at(baudRate()) * baudDelayFactor_;
+    const auto cycle = board()->cycleCount();
+
+    if (cycle >= transmitDoneCycle_)
+        finishTransmit();
+
+    if (cycle >= receiveDoneCycle_)
+        finishReceive();
 }
 
-void ACIA::transmitDelayTimeout()
+void ACIA::finishTransmit()
 {
+    transmitDoneCycle_ = NoEvent;
+
     emit sendByte(transmitData_);
     emit transmittingChanged();
 
@@ -240,8 +320,10 @@ void ACIA::transmitDelayTimeout()
     // - no irq
 }
 
-void ACIA::receiveDelayTimeout()
+void ACIA::finishReceive()
 {
+    receiveDoneCycle_ = NoEvent;
+
     uint8_t byte = receiveBuffer_.takeFirst();
 
     if (statusRegister_ & ReceiverFull)
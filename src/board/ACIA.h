@@ -15,9 +15,7 @@
 
 #include "Device.h"
 
-class QTimer;
-
-class ACIA : public Device
+class ACIA final : public Device
 {
     Q_OBJECT
 
@@ -34,6 +32,12 @@ public:
         IRQ = 0x80,
     };
 
+    static constexpr double DefaultCrystalFrequency = 1843200.0;
+    static constexpr double DefaultClockFrequency = 1000000.0;
+
+    // input channel, receiving a byte
+    static constexpr uint8_t SerialInput = 0;
+
 public:
     ACIA(const QString& name, Board* board);
     ~ACIA() override;
@@ -47,7 +51,15 @@ public:
     uint8_t transmitterBuffer() const { return transmitData_; }
     uint8_t receiverBuffer() const { return receiveData_; }
 
-    void setBaudDelayFactor(int factor);
+    // baud rates are derived from the crystal and counted in cycles of the board clock, which
+    // the cpu runs at on the real board independent of the emulation speed
+    double crystalFrequency() const { return crystalFrequency_; }
+    void setCrystalFrequency(double frequency);
+    double clockFrequency() const { return clockFrequency_; }
+    void setClockFrequency(double frequency);
+
+    uint64_t nextEventCycle() const override;
+    void applyInput(uint8_t channel, uint32_t value) override;
 
 signals:
     void sendByte(uint8_t byte);
@@ -61,6 +73,8 @@ public slots:
 protected:
     int32_t calcMapAddressEnd() const override;
     void deviceClockEdge(StateEdge edge) override;
+    void saveState(QDataStream& stream) const override;
+    void restoreState(QDataStream& stream) override;
 
 private:
     void resetChip(bool hard);
@@ -69,22 +83,26 @@ private:
     void populateGlobalState();
     void startTransmit();
     void startReceive();
-    int baudDelay();
-
-private slots:
-    void transmitDelayTimeout();
-    void receiveDelayTimeout();
+    uint64_t frameCycles() const;
+    void finishTransfers();
+    void finishTransmit();
+    void finishReceive();
 
 private:
     QVector<uint8_t> receiveBuffer_;
-    QTimer* transmitDelay_;
-    QTimer* receiveDelay_;
-    int baudDelayFactor_{10};
+    double crystalFrequency_{DefaultCrystalFrequency};
+    double clockFrequency_{DefaultClockFrequency};
+    // cycle the running transfer completes in, NoEvent while idle
+    uint64_t transmitDoneCycle_{NoEvent};
+    uint64_t receiveDoneCycle_{NoEvent};
     uint8_t controlRegister_{};
     uint8_t commandRegister_{};
     uint8_t transmitData_{};
     uint8_t receiveData_{};
     uint8_t statusRegister_{TransmitterEmpty};
 
+    // static dispatches tick the concrete type without virtual calls
+    friend class Board;
+
     Q_DISABLE_COPY_MOVE(ACIA)
 };
@@ -0,0 +1,771 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BlockCache.h"
+
+#include "Board.h"
+#include "impl/m6502.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace {
+
+constexpr int32_t AddressSpaceSize = 0x10000;
+constexpr int32_t PageSize = 0x100;
+constexpr size_t MaxBlockInstructions = 32;
+// dropped blocks keep their slot, the whole cache is cleared when this many were translated
+constexpr size_t MaxBlocks = 0x4000;
+
+using Context = BlockCache::Context;
+using Handler = BlockCache::Handler;
+using Instruction = BlockCache::Instruction;
+using Registers = BlockCache::Registers;
+
+enum class Mode
+{
+    Implied,
+    Immediate,
+    ZeroPage,
+    ZeroPageX,
+    ZeroPageY,
+    Absolute,
+    AbsoluteX,
+    AbsoluteY,
+    IndirectX,
+    IndirectY,
+};
+
+// the instruction semantics follow impl/m6502.h, including its decimal mode
+
+uint8_t nz(uint8_t p, uint8_t value)
+{
+    return static_cast<uint8_t>((p & ~(M6502_NF | M6502_ZF)) | (value ? (value & M6502_NF) : M6502_ZF));
+}
+
+void clearFlags(uint8_t& p, int flags)
+{
+    p = static_cast<uint8_t>(p & ~flags);
+}
+
+bool read(Context& context, uint16_t address, uint8_t& value)
+{
+    return context.board->readDirect(address, value);
+}
+
+bool write(Context& context, uint16_t address, uint8_t value)
+{
+    if (!context.board->isDirect(address))
+        return false;
+
+    context.writeAddresses[context.writeCount] = address;
+    context.writeData[context.writeCount] = value;
+    ++context.writeCount;
+    return true;
+}
+
+bool push(Context& context, uint8_t value)
+{
+    if (!write(context, 0x0100 | context.registers.s, value))
+        return false;
+    --context.registers.s;
+    return true;
+}
+
+bool pull(Context& context, uint8_t& value)
+{
+    if (!read(context, 0x0100 | static_cast<uint8_t>(context.registers.s + 1), value))
+        return false;
+    ++context.registers.s;
+    return true;
+}
+
+// the cpu first reads the address with the unfixed high byte, on a page crossing that read
+// hits the page of the base
+bool index(Context& context, uint16_t base, uint8_t offset, bool write, uint16_t& address)
+{
+    address = static_cast<uint16_t>(base + offset);
+    if (((base ^ address) & 0xFF00) == 0)
+        return true;
+
+    if (!write)
+        ++context.cycles;
+    return context.board->isDirect(base);
+}
+
+template<Mode mode>
+bool effectiveAddress(Context& context, const Instruction& instruction, bool write, uint16_t& address)
+{
+    const auto& registers = context.registers;
+    const uint16_t operand = instruction.operand;
+
+    if constexpr (mode == Mode::ZeroPage)
+    {
+        address = operand;
+    }
+    else if constexpr (mode == Mode::ZeroPageX)
+    {
+        address = (operand + registers.x) & 0xFF;
+    }
+    else if constexpr (mode == Mode::ZeroPageY)
+    {
+        address = (operand + registers.y) & 0xFF;
+    }
+    else if constexpr (mode == Mode::Absolute)
+    {
+        address = operand;
+    }
+    else if constexpr (mode == Mode::AbsoluteX)
+    {
+        return index(context, operand, registers.x, write, address);
+    }
+    else if constexpr (mode == Mode::AbsoluteY)
+    {
+        return index(context, operand, registers.y, write, address);
+    }
+    else if constexpr (mode == Mode::IndirectX)
+    {
+        const uint8_t pointer = static_cast<uint8_t>(operand + registers.x);
+        uint8_t low{};
+        uint8_t high{};
+        if (!read(context, pointer, low) || !read(context, static_cast<uint8_t>(pointer + 1), high))
+            return false;
+        address = static_cast<uint16_t>(low | high << 8);
+    }
+    else if constexpr (mode == Mode::IndirectY)
+    {
+        uint8_t low{};
+        uint8_t high{};
+        if (!read(context, operand, low) || !read(context, static_cast<uint8_t>(operand + 1), high))
+            return false;
+        return index(context, static_cast<uint16_t>(low | high << 8), registers.y, write, address);
+    }
+    else
+    {
+        static_assert(mode != mode, "Addressing mode has no effective address");
+    }
+
+    return true;
+}
+
+using ReadOp = void (*)(Registers& registers, uint8_t value, bool decimalEnabled);
+using StoreOp = uint8_t (*)(const Registers& registers);
+using ModifyOp = uint8_t (*)(Registers& registers, uint8_t value);
+using ImpliedOp = void (*)(Registers& registers);
+
+template<Mode mode, ReadOp op>
+bool readInstruction(Context& context, const Instruction& instruction)
+{
+    uint8_t value{};
+    if constexpr (mode == Mode::Immediate)
+    {
+        value = static_cast<uint8_t>(instruction.operand);
+    }
+    else
+    {
+        uint16_t address{};
+        if (!effectiveAddress<mode>(context, instruction, false, address) || !read(context, address, value))
+            return false;
+    }
+
+    op(context.registers, value, context.decimalEnabled);
+    return true;
+}
+
+template<Mode mode, StoreOp op>
+bool storeInstruction(Context& context, const Instruction& instruction)
+{
+    uint16_t address{};
+    return effectiveAddress<mode>(context, instruction, true, address) &&
+            write(context, address, op(context.registers));
+}
+
+template<Mode mode, ModifyOp op>
+bool modifyInstruction(Context& context, const Instruction& instruction)
+{
+    if constexpr (mode == Mode::Implied)
+    {
+        context.registers.a = op(context.registers, context.registers.a);
+        return true;
+    }
+    else
+    {
+        uint16_t address{};
+        uint8_t value{};
+        if (!effectiveAddress<mode>(context, instruction, true, address) || !read(context, address, value))
+            return false;
+        return write(context, address, op(context.registers, value));
+    }
+}
+
+template<ImpliedOp op>
+bool impliedInstruction(Context& context, const Instruction& /*instruction*/)
+{
+    op(context.registers);
+    return true;
+}
+
+template<uint8_t flag, bool set>
+bool branchInstruction(Context& context, const Instruction& instruction)
+{
+    auto& registers = context.registers;
+    if (((registers.p & flag) != 0) != set)
+        return true;
+
+    // the taken branch reads the next opcode, which is in a page of the block
+    const auto target = static_cast<uint16_t>(registers.pc + static_cast<int8_t>(instruction.operand));
+    context.cycles += ((target ^ registers.pc) & 0xFF00) ? 2 : 1;
+    registers.pc = target;
+    return true;
+}
+
+void lda(Registers& r, uint8_t value, bool) { r.a = value; r.p = nz(r.p, r.a); }
+void ldx(Registers& r, uint8_t value, bool) { r.x = value; r.p = nz(r.p, r.x); }
+void ldy(Registers& r, uint8_t value, bool) { r.y = value; r.p = nz(r.p, r.y); }
+void ora(Registers& r, uint8_t value, bool) { r.a |= value; r.p = nz(r.p, r.a); }
+void and_(Registers& r, uint8_t value, bool) { r.a &= value; r.p = nz(r.p, r.a); }
+void eor(Registers& r, uint8_t value, bool) { r.a ^= value; r.p = nz(r.p, r.a); }
+
+void compare(Registers& r, uint8_t reg, uint8_t value)
+{
+    const uint16_t t = static_cast<uint16_t>(reg - value);
+    r.p = static_cast<uint8_t>((nz(r.p, static_cast<uint8_t>(t)) & ~M6502_CF) | ((t & 0xFF00) ? 0 : M6502_CF));
+}
+
+void cmp(Registers& r, uint8_t value, bool) { compare(r, r.a, value); }
+void cpx(Registers& r, uint8_t value, bool) { compare(r, r.x, value); }
+void cpy(Registers& r, uint8_t value, bool) { compare(r, r.y, value); }
+
+void bit(Registers& r, uint8_t value, bool)
+{
+    clearFlags(r.p, M6502_NF | M6502_VF | M6502_ZF);
+    if (!(r.a & value))
+        r.p |= M6502_ZF;
+    r.p |= value & (M6502_NF | M6502_VF);
+}
+
+void adc(Registers& r, uint8_t value, bool decimalEnabled)
+{
+    if (decimalEnabled && (r.p & M6502_DF))
+    {
+        const uint8_t c = (r.p & M6502_CF) ? 1 : 0;
+        clearFlags(r.p, M6502_NF | M6502_VF | M6502_ZF | M6502_CF);
+        uint8_t al = static_cast<uint8_t>((r.a & 0x0F) + (value & 0x0F) + c);
+        if (al > 9)
+            al += 6;
+        uint8_t ah = static_cast<uint8_t>((r.a >> 4) + (value >> 4) + (al > 0x0F));
+        if (static_cast<uint8_t>(r.a + value + c) == 0)
+            r.p |= M6502_ZF;
+        else if (ah & 0x08)
+            r.p |= M6502_NF;
+        if (~(r.a ^ value) & (r.a ^ (ah << 4)) & 0x80)
+            r.p |= M6502_VF;
+        if (ah > 9)
+            ah += 6;
+        if (ah > 15)
+            r.p |= M6502_CF;
+        r.a = static_cast<uint8_t>((ah << 4) | (al & 0x0F));
+    }
+    else
+    {
+        const uint16_t sum = static_cast<uint16_t>(r.a + value + ((r.p & M6502_CF) ? 1 : 0));
+        clearFlags(r.p, M6502_VF | M6502_CF);
+        r.p = nz(r.p, static_cast<uint8_t>(sum));
+        if (~(r.a ^ value) & (r.a ^ sum) & 0x80)
+            r.p |= M6502_VF;
+        if (sum & 0xFF00)
+            r.p |= M6502_CF;
+        r.a = static_cast<uint8_t>(sum);
+    }
+}
+
+void sbc(Registers& r, uint8_t value, bool decimalEnabled)
+{
+    if (decimalEnabled && (r.p & M6502_DF))
+    {
+        const uint8_t c = (r.p & M6502_CF) ? 0 : 1;
+        clearFlags(r.p, M6502_NF | M6502_VF | M6502_ZF | M6502_CF);
+        const uint16_t diff = static_cast<uint16_t>(r.a - value - c);
+        uint8_t al = static_cast<uint8_t>((r.a & 0x0F) - (value & 0x0F) - c);
+        if (static_cast<int8_t>(al) < 0)
+            al -= 6;
+        uint8_t ah = static_cast<uint8_t>((r.a >> 4) - (value >> 4) - (static_cast<int8_t>(al) < 0));
+        if (static_cast<uint8_t>(diff) == 0)
+            r.p |= M6502_ZF;
+        else if (diff & 0x80)
+            r.p |= M6502_NF;
+        if ((r.a ^ value) & (r.a ^ diff) & 0x80)
+            r.p |= M6502_VF;
+        if (!(diff & 0xFF00))
+            r.p |= M6502_CF;
+        if (ah & 0x80)
+            ah -= 6;
+        r.a = static_cast<uint8_t>((ah << 4) | (al & 0x0F));
+    }
+    else
+    {
+        const uint16_t diff = static_cast<uint16_t>(r.a - value - ((r.p & M6502_CF) ? 0 : 1));
+        clearFlags(r.p, M6502_VF | M6502_CF);
+        r.p = nz(r.p, static_cast<uint8_t>(diff));
+        if ((r.a ^ value) & (r.a ^ diff) & 0x80)
+            r.p |= M6502_VF;
+        if (!(diff & 0xFF00))
+            r.p |= M6502_CF;
+        r.a = static_cast<uint8_t>(diff);
+    }
+}
+
+uint8_t sta(const Registers& r) { return r.a; }
+uint8_t stx(const Registers& r) { return r.x; }
+uint8_t sty(const Registers& r) { return r.y; }
+
+uint8_t asl(Registers& r, uint8_t value)
+{
+    const auto result = static_cast<uint8_t>(value << 1);
+    r.p = static_cast<uint8_t>((nz(r.p, result) & ~M6502_CF) | ((value & 0x80) ? M6502_CF : 0));
+    return result;
+}
+
+uint8_t lsr(Registers& r, uint8_t value)
+{
+    const auto result = static_cast<uint8_t>(value >> 1);
+    r.p = static_cast<uint8_t>((nz(r.p, result) & ~M6502_CF) | ((value & 0x01) ? M6502_CF : 0));
+    return result;
+}
+
+uint8_t rol(Registers& r, uint8_t value)
+{
+    const auto result = static_cast<uint8_t>((value << 1) | ((r.p & M6502_CF) ? 0x01 : 0));
+    r.p = static_cast<uint8_t>((nz(r.p, result) & ~M6502_CF) | ((value & 0x80) ? M6502_CF : 0));
+    return result;
+}
+
+uint8_t ror(Registers& r, uint8_t value)
+{
+    const auto result = static_cast<uint8_t>((value >> 1) | ((r.p & M6502_CF) ? 0x80 : 0));
+    r.p = static_cast<uint8_t>((nz(r.p, result) & ~M6502_CF) | ((value & 0x01) ? M6502_CF : 0));
+    return result;
+}
+
+uint8_t inc(Registers& r, uint8_t value)
+{
+    const auto result = static_cast<uint8_t>(value + 1);
+    r.p = nz(r.p, result);
+    return result;
+}
+
+uint8_t dec(Registers& r, uint8_t value)
+{
+    const auto result = static_cast<uint8_t>(value - 1);
+    r.p = nz(r.p, result);
+    return result;
+}
+
+void tax(Registers& r) { r.x = r.a; r.p = nz(r.p, r.x); }
+void tay(Registers& r) { r.y = r.a; r.p = nz(r.p, r.y); }
+void txa(Registers& r) { r.a = r.x; r.p = nz(r.p, r.a); }
+void tya(Registers& r) { r.a = r.y; r.p = nz(r.p, r.a); }
+void tsx(Registers& r) { r.x = r.s; r.p = nz(r.p, r.x); }
+void txs(Registers& r) { r.s = r.x; }
+void inx(Registers& r) { ++r.x; r.p = nz(r.p, r.x); }
+void iny(Registers& r) { ++r.y; r.p = nz(r.p, r.y); }
+void dex(Registers& r) { --r.x; r.p = nz(r.p, r.x); }
+void dey(Registers& r) { --r.y; r.p = nz(r.p, r.y); }
+void clc(Registers& r) { clearFlags(r.p, M6502_CF); }
+void sec(Registers& r) { r.p |= M6502_CF; }
+void cli(Registers& r) { clearFlags(r.p, M6502_IF); }
+void sei(Registers& r) { r.p |= M6502_IF; }
+void clv(Registers& r) { clearFlags(r.p, M6502_VF); }
+void cld(Registers& r) { clearFlags(r.p, M6502_DF); }
+void sed(Registers& r) { r.p |= M6502_DF; }
+void nop(Registers&) {}
+
+bool pha(Context& context, const Instruction&)
+{
+    return push(context, context.registers.a);
+}
+
+bool php(Context& context, const Instruction&)
+{
+    return push(context, context.registers.p | M6502_XF);
+}
+
+bool pla(Context& context, const Instruction&)
+{
+    auto& registers = context.registers;
+    if (!pull(context, registers.a))
+        return false;
+    registers.p = nz(registers.p, registers.a);
+    return true;
+}
+
+bool plp(Context& context, const Instruction&)
+{
+    auto& registers = context.registers;
+    uint8_t value{};
+    if (!pull(context, value))
+        return false;
+    registers.p = static_cast<uint8_t>((value | M6502_BF) & ~M6502_XF);
+    return true;
+}
+
+bool jmp(Context& context, const Instruction& instruction)
+{
+    context.registers.pc = instruction.operand;
+    return true;
+}
+
+bool jmpIndirect(Context& context, const Instruction& instruction)
+{
+    // the high byte of the pointer is not incremented
+    const uint16_t pointer = instruction.operand;
+    uint8_t low{};
+    uint8_t high{};
+    if (!read(context, pointer, low) || !read(context, (pointer & 0xFF00) | ((pointer + 1) & 0x00FF), high))
+        return false;
+    context.registers.pc = static_cast<uint16_t>(low | high << 8);
+    return true;
+}
+
+bool jsr(Context& context, const Instruction& instruction)
+{
+    // pushes the address of its last byte
+    const auto returnAddress = static_cast<uint16_t>(instruction.address + 2);
+    if (!push(context, static_cast<uint8_t>(returnAddress >> 8)) ||
+        !push(context, static_cast<uint8_t>(returnAddress)))
+        return false;
+    context.registers.pc = instruction.operand;
+    return true;
+}
+
+bool rts(Context& context, const Instruction&)
+{
+    uint8_t low{};
+    uint8_t high{};
+    if (!pull(context, low) || !pull(context, high))
+        return false;
+
+    // the pulled address is read once before it is incremented
+    const auto address = static_cast<uint16_t>(low | high << 8);
+    if (!context.board->isDirect(address))
+        return false;
+
+    context.registers.pc = static_cast<uint16_t>(address + 1);
+    return true;
+}
+
+struct OpcodeInfo
+{
+    Handler handler;
+    uint8_t length;
+    uint8_t cycles;
+    bool endsBlock;
+};
+
+class OpcodeTable
+{
+public:
+    OpcodeTable()
+    {
+        addRead<ora>(0x09, 0x05, 0x15, 0x0D, 0x1D, 0x19, 0x01, 0x11);
+        addRead<and_>(0x29, 0x25, 0x35, 0x2D, 0x3D, 0x39, 0x21, 0x31);
+        addRead<eor>(0x49, 0x45, 0x55, 0x4D, 0x5D, 0x59, 0x41, 0x51);
+        addRead<adc>(0x69, 0x65, 0x75, 0x6D, 0x7D, 0x79, 0x61, 0x71);
+        addRead<lda>(0xA9, 0xA5, 0xB5, 0xAD, 0xBD, 0xB9, 0xA1, 0xB1);
+        addRead<cmp>(0xC9, 0xC5, 0xD5, 0xCD, 0xDD, 0xD9, 0xC1, 0xD1);
+        addRead<sbc>(0xE9, 0xE5, 0xF5, 0xED, 0xFD, 0xF9, 0xE1, 0xF1);
+
+        add(0xA2, readInstruction<Mode::Immediate, ldx>, 2, 2);
+        add(0xA6, readInstruction<Mode::ZeroPage, ldx>, 2, 3);
+        add(0xB6, readInstruction<Mode::ZeroPageY, ldx>, 2, 4);
+        add(0xAE, readInstruction<Mode::Absolute, ldx>, 3, 4);
+        add(0xBE, readInstruction<Mode::AbsoluteY, ldx>, 3, 4);
+
+        add(0xA0, readInstruction<Mode::Immediate, ldy>, 2, 2);
+        add(0xA4, readInstruction<Mode::ZeroPage, ldy>, 2, 3);
+        add(0xB4, readInstruction<Mode::ZeroPageX, ldy>, 2, 4);
+        add(0xAC, readInstruction<Mode::Absolute, ldy>, 3, 4);
+        add(0xBC, readInstruction<Mode::AbsoluteX, ldy>, 3, 4);
+
+        add(0xE0, readInstruction<Mode::Immediate, cpx>, 2, 2);
+        add(0xE4, readInstruction<Mode::ZeroPage, cpx>, 2, 3);
+        add(0xEC, readInstruction<Mode::Absolute, cpx>, 3, 4);
+        add(0xC0, readInstruction<Mode::Immediate, cpy>, 2, 2);
+        add(0xC4, readInstruction<Mode::ZeroPage, cpy>, 2, 3);
+        add(0xCC, readInstruction<Mode::Absolute, cpy>, 3, 4);
+
+        add(0x24, readInstruction<Mode::ZeroPage, bit>, 2, 3);
+        add(0x2C, readInstruction<Mode::Absolute, bit>, 3, 4);
+
+        add(0x85, storeInstruction<Mode::ZeroPage, sta>, 2, 3);
+        add(0x95, storeInstruction<Mode::ZeroPageX, sta>, 2, 4);
+        add(0x8D, storeInstruction<Mode::Absolute, sta>, 3, 4);
+        add(0x9D, storeInstruction<Mode::AbsoluteX, sta>, 3, 5);
+        add(0x99, storeInstruction<Mode::AbsoluteY, sta>, 3, 5);
+        add(0x81, storeInstruction<Mode::IndirectX, sta>, 2, 6);
+        add(0x91, storeInstruction<Mode::IndirectY, sta>, 2, 6);
+        add(0x86, storeInstruction<Mode::ZeroPage, stx>, 2, 3);
+        add(0x96, storeInstruction<Mode::ZeroPageY, stx>, 2, 4);
+        add(0x8E, storeInstruction<Mode::Absolute, stx>, 3, 4);
+        add(0x84, storeInstruction<Mode::ZeroPage, sty>, 2, 3);
+        add(0x94, storeInstruction<Mode::ZeroPageX, sty>, 2, 4);
+        add(0x8C, storeInstruction<Mode::Absolute, sty>, 3, 4);
+
+        addModify<asl>(0x0A, 0x06, 0x16, 0x0E, 0x1E);
+        addModify<rol>(0x2A, 0x26, 0x36, 0x2E, 0x3E);
+        addModify<lsr>(0x4A, 0x46, 0x56, 0x4E, 0x5E);
+        addModify<ror>(0x6A, 0x66, 0x76, 0x6E, 0x7E);
+        addModify<inc>(0x00, 0xE6, 0xF6, 0xEE, 0xFE);
+        addModify<dec>(0x00, 0xC6, 0xD6, 0xCE, 0xDE);
+
+        add(0xAA, impliedInstruction<tax>, 1, 2);
+        add(0xA8, impliedInstruction<tay>, 1, 2);
+        add(0x8A, impliedInstruction<txa>, 1, 2);
+        add(0x98, impliedInstruction<tya>, 1, 2);
+        add(0xBA, impliedInstruction<tsx>, 1, 2);
+        add(0x9A, impliedInstruction<txs>, 1, 2);
+        add(0xE8, impliedInstruction<inx>, 1, 2);
+        add(0xC8, impliedInstruction<iny>, 1, 2);
+        add(0xCA, impliedInstruction<dex>, 1, 2);
+        add(0x88, impliedInstruction<dey>, 1, 2);
+        add(0x18, impliedInstruction<clc>, 1, 2);
+        add(0x38, impliedInstruction<sec>, 1, 2);
+        add(0x58, impliedInstruction<cli>, 1, 2);
+        add(0x78, impliedInstruction<sei>, 1, 2);
+        add(0xB8, impliedInstruction<clv>, 1, 2);
+        add(0xD8, impliedInstruction<cld>, 1, 2);
+        add(0xF8, impliedInstruction<sed>, 1, 2);
+        add(0xEA, impliedInstruction<nop>, 1, 2);
+
+        add(0x48, pha, 1, 3);
+        add(0x08, php, 1, 3);
+        add(0x68, pla, 1, 4);
+        add(0x28, plp, 1, 4);
+
+        add(0x10, branchInstruction<M6502_NF, false>, 2, 2, true);
+        add(0x30, branchInstruction<M6502_NF, true>, 2, 2, true);
+        add(0x50, branchInstruction<M6502_VF, false>, 2, 2, true);
+        add(0x70, branchInstruction<M6502_VF, true>, 2, 2, true);
+        add(0x90, branchInstruction<M6502_CF, false>, 2, 2, true);
+        add(0xB0, branchInstruction<M6502_CF, true>, 2, 2, true);
+        add(0xD0, branchInstruction<M6502_ZF, false>, 2, 2, true);
+        add(0xF0, branchInstruction<M6502_ZF, true>, 2, 2, true);
+
+        add(0x4C, jmp, 3, 3, true);
+        add(0x6C, jmpIndirect, 3, 5, true);
+        add(0x20, jsr, 3, 6, true);
+        add(0x60, rts, 1, 6, true);
+
+        // brk, rti and the undocumented opcodes are left to the cycle accurate core
+    }
+
+    const OpcodeInfo& operator[](uint8_t opcode) const { return infos_[opcode]; }
+
+private:
+    void add(uint8_t opcode, Handler handler, uint8_t length, uint8_t cycles, bool endsBlock = false)
+    {
+        infos_[opcode] = {handler, length, cycles, endsBlock};
+    }
+
+    template<ReadOp op>
+    void addRead(uint8_t immediate, uint8_t zeroPage, uint8_t zeroPageX, uint8_t absolute, uint8_t absoluteX,
+                 uint8_t absoluteY, uint8_t indirectX, uint8_t indirectY)
+    {
+        add(immediate, readInstruction<Mode::Immediate, op>, 2, 2);
+        add(zeroPage, readInstruction<Mode::ZeroPage, op>, 2, 3);
+        add(zeroPageX, readInstruction<Mode::ZeroPageX, op>, 2, 4);
+        add(absolute, readInstruction<Mode::Absolute, op>, 3, 4);
+        add(absoluteX, readInstruction<Mode::AbsoluteX, op>, 3, 4);
+        add(absoluteY, readInstruction<Mode::AbsoluteY, op>, 3, 4);
+        add(indirectX, readInstruction<Mode::IndirectX, op>, 2, 6);
+        add(indirectY, readInstruction<Mode::IndirectY, op>, 2, 5);
+    }
+
+    // an accumulator opcode of 0 means there is none
+    template<ModifyOp op>
+    void addModify(uint8_t accumulator, uint8_t zeroPage, uint8_t zeroPageX, uint8_t absolute, uint8_t absoluteX)
+    {
+        if (accumulator != 0)
+            add(accumulator, modifyInstruction<Mode::Implied, op>, 1, 2);
+        add(zeroPage, modifyInstruction<Mode::ZeroPage, op>, 2, 5);
+        add(zeroPageX, modifyInstruction<Mode::ZeroPageX, op>, 2, 6);
+        add(absolute, modifyInstruction<Mode::Absolute, op>, 3, 6);
+        add(absoluteX, modifyInstruction<Mode::AbsoluteX, op>, 3, 7);
+    }
+
+private:
+    std::array<OpcodeInfo, 256> infos_{};
+};
+
+const OpcodeTable opcodeTable;
+
+} // namespace
+
+BlockCache::BlockCache() :
+    blockIndex_(AddressSpaceSize, 0),
+    blocks_{},
+    codeBytes_(AddressSpaceSize, 0),
+    pageBlocks_(AddressSpaceSize / PageSize),
+    currentBlock_{-1},
+    currentInstruction_{0}
+{
+}
+
+uint32_t BlockCache::execute(Board* board, Registers& registers, bool decimalEnabled, uint8_t& nextOpcode)
+{
+    // follow the current block as long as execution runs straight through it
+    if (currentBlock_ < 0 || blocks_[static_cast<size_t>(currentBlock_)].instructions[currentInstruction_].address != registers.pc)
+    {
+        auto index = blockIndex_[registers.pc] - 1;
+        if (index < 0)
+            index = translate(board, registers.pc);
+
+        if (!enterBlock(board, index))
+        {
+            currentBlock_ = -1;
+            return 0;
+        }
+
+        currentBlock_ = index;
+        currentInstruction_ = 0;
+    }
+
+    const auto& block = blocks_[static_cast<size_t>(currentBlock_)];
+    const auto& instruction = block.instructions[currentInstruction_];
+
+    Context context{board, registers, decimalEnabled, instruction.cycles, 0, {}, {}};
+    context.registers.pc = static_cast<uint16_t>(instruction.address + instruction.length);
+
+    if (!instruction.handler(context, instruction))
+        return 0;
+
+    // the opcode fetch ends the instruction, it is known already while running through a block
+    const auto next = currentInstruction_ + 1;
+    if (context.registers.pc == instruction.address + instruction.length && next < block.instructions.size())
+    {
+        nextOpcode = block.instructions[next].opcode;
+        currentInstruction_ = next;
+    }
+    else
+    {
+        if (!board->isDirect(context.registers.pc))
+            return 0;
+        currentBlock_ = -1;
+    }
+
+    // may drop the executed block when the code modifies itself
+    for (uint32_t i = 0; i < context.writeCount; ++i)
+        board->writeDirect(context.writeAddresses[i], context.writeData[i]);
+
+    if (currentBlock_ < 0)
+        board->readDirect(context.registers.pc, nextOpcode);
+
+    registers = context.registers;
+    return context.cycles;
+}
+
+void BlockCache::clear()
+{
+    std::fill(blockIndex_.begin(), blockIndex_.end(), 0);
+    std::fill(codeBytes_.begin(), codeBytes_.end(), 0);
+    for (auto& blocks : pageBlocks_)
+        blocks.clear();
+    blocks_.clear();
+    currentBlock_ = -1;
+}
+
+int32_t BlockCache::translate(Board* board, uint16_t address)
+{
+    if (blocks_.size() >= MaxBlocks)
+        clear();
+
+    Block block{address, address, {}};
+    while (block.instructions.size() < MaxBlockInstructions)
+    {
+        uint8_t opcode{};
+        if (!board->readDirect(static_cast<uint16_t>(block.end), opcode))
+            break;
+
+        const auto& info = opcodeTable[opcode];
+        if (!info.handler || block.end + info.length >= AddressSpaceSize)
+            break;
+
+        uint8_t operand[2]{};
+        bool direct = true;
+        for (uint32_t i = 1; i < info.length && direct; ++i)
+            direct = board->readDirect(static_cast<uint16_t>(block.end + i), operand[i - 1]);
+        if (!direct)
+            break;
+
+        block.instructions.push_back({info.handler, static_cast<uint16_t>(block.end),
+                                      static_cast<uint16_t>(operand[0] | operand[1] << 8), opcode, info.length,
+                                      info.cycles});
+        block.end += info.length;
+
+        if (info.endsBlock)
+            break;
+    }
+
+    if (block.instructions.empty())
+        return -1;
+
+    std::fill(codeBytes_.begin() + block.start, codeBytes_.begin() + block.end, 1);
+
+    const auto index = static_cast<int32_t>(blocks_.size());
+    for (uint32_t page = block.start / PageSize; page <= (block.end - 1) / PageSize; ++page)
+        pageBlocks_[page].push_back(index);
+
+    blocks_.push_back(std::move(block));
+    blockIndex_[address] = index + 1;
+    return index;
+}
+
+bool BlockCache::enterBlock(Board* board, int32_t index) const
+{
+    if (index < 0)
+        return false;
+
+    // a memory may have become observed since the translation, the page after the block is
+    // covered as well for the reads at the end of an instruction
+    const auto& block = blocks_[static_cast<size_t>(index)];
+    for (uint32_t page = block.start / PageSize; page <= block.end / PageSize; ++page)
+    {
+        if (!board->isDirect(static_cast<uint16_t>(page * PageSize)))
+            return false;
+    }
+    return true;
+}
+
+void BlockCache::invalidateBlocks(uint16_t address)
+{
+    auto& pageBlocks = pageBlocks_[address / PageSize];
+    for (const auto index : pageBlocks)
+    {
+        auto& block = blocks_[static_cast<size_t>(index)];
+        if (block.instructions.empty() || address < block.start || address >= block.end)
+            continue;
+
+        blockIndex_[block.start] = 0;
+        block.instructions.clear();
+
+        if (currentBlock_ == index)
+            currentBlock_ = -1;
+    }
+
+    pageBlocks.erase(std::remove_if(pageBlocks.begin(), pageBlocks.end(), [this](int32_t index) {
+        return blocks_[static_cast<size_t>(index)].instructions.empty();
+    }), pageBlocks.end());
+
+    // every block covering the address is gone
+    codeBytes_[address] = 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Board;
+
+// Translation cache for straight-line 6502 code. Basic blocks are decoded once into handlers
+// with their operands and then executed instruction by instruction against directly
+// accessible memory. Writes into decoded code drop the blocks covering it.
+class BlockCache
+{
+public:
+    struct Registers
+    {
+        uint16_t pc;
+        uint8_t a;
+        uint8_t x;
+        uint8_t y;
+        uint8_t s;
+        uint8_t p;
+    };
+
+    struct Context;
+    struct Instruction;
+    using Handler = bool (*)(Context& context, const Instruction& instruction);
+
+    struct Instruction
+    {
+        Handler handler;
+        uint16_t address;
+        uint16_t operand;
+        uint8_t opcode;
+        uint8_t length;
+        uint8_t cycles;
+    };
+
+    // state of one executed instruction, writes are held back until it completed
+    struct Context
+    {
+        Board* board;
+        Registers registers;
+        bool decimalEnabled;
+        uint32_t cycles;
+        uint32_t writeCount;
+        uint16_t writeAddresses[2];
+        uint8_t writeData[2];
+    };
+
+public:
+    BlockCache();
+
+    // executes the instruction at registers.pc and returns its cycles and the opcode fetched
+    // after it; returns zero without any change when an access is not served directly or the
+    // opcode is not translated, the cycle accurate core has to run it then
+    uint32_t execute(Board* board, Registers& registers, bool decimalEnabled, uint8_t& nextOpcode);
+
+    // called before every cpu write
+    void invalidate(uint16_t address)
+    {
+        if (codeBytes_[address])
+            invalidateBlocks(address);
+    }
+
+    void clear();
+
+private:
+    struct Block
+    {
+        uint16_t start;
+        // one after the last instruction
+        uint32_t end;
+        std::vector<Instruction> instructions;
+    };
+
+private:
+    int32_t translate(Board* board, uint16_t address);
+    bool enterBlock(Board* board, int32_t index) const;
+    void invalidateBlocks(uint16_t address);
+
+private:
+    // index + 1 into blocks_ of the block starting at an address, 0 means not translated
+    std::vector<int32_t> blockIndex_;
+    std::vector<Block> blocks_;
+    // set for every byte a block was decoded from
+    std::vector<uint8_t> codeBytes_;
+    // indices into blocks_ of the blocks decoded from each page, dropped ones stay until clear()
+    std::vector<std::vector<int32_t>> pageBlocks_;
+    int32_t currentBlock_;
+    uint32_t currentInstruction_;
+};
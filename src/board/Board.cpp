@@ -14,17 +14,31 @@
 #include "Board.h"
 
 #include "Bus.h"
+#include "BusConnection.h"
 #include "Clock.h"
 #include "CPU.h"
 #include "Debugger.h"
 #include "Device.h"
+#include "Memory.h"
+#include "StaticBoard.h"
 #include <QChildEvent>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
 #include <QFile>
+#include <QHash>
+#include <QMetaMethod>
+#include <QPointer>
 #include <QTimer>
 #include <QThread>
 
 namespace {
 
+constexpr uint32_t DefaultRunSliceCycles = 100000;
+constexpr quint32 SnapshotVersion = 4;
+constexpr int32_t AddressSpaceSize = 0x10000;
+constexpr int32_t PageSize = 0x100;
+
 } // namespace
 
 Board::Board(QObject* parent) :
@@ -33,16 +47,29 @@ Board::Board(QObject* parent) :
     dataBus_{new Bus{QStringLiteral("DATA"), CPU::DATA_BUS_WIDTH, this}},
     busses_{},
     devices_{},
-    resetLine_{WireState::High},
-    rwLine_{WireState::Low},
-    irqLine_{WireState::High},
-    nmiLine_{WireState::High},
-    syncLine_{WireState::Low},
+    tickingDevices_{},
+    wakeQueue_{},
+    awakeDevices_{},
+    decodeTable_(AddressSpaceSize, 0),
+    selectedDevice_{},
+    directPages_(AddressSpaceSize / PageSize, DirectPage{}),
+    controlLines_{ResetLine | IrqLine | NmiLine},
+    notifiedControlLines_{controlLines_},
+    cycleCount_{0},
+    runSliceCycles_{DefaultRunSliceCycles},
+    instructionStepping_{false},
+    blockCaching_{true},
+    blockCache_{},
+    history_{},
+    inputLog_{},
+    dispatch_{},
+    dispatchBound_{false},
     cpu_{new CPU{this}},
     clock_{new Clock{this}},
     debugger_{new Debugger(this)}
 {
     connect(clock_, &Clock::clockCycleChanged, this, &Board::onClockCycleChanged);
+    clock_->setCycleRunner([this](uint64_t cycles) { return runCycles(cycles, {}); });
 }
 
 Board::~Board()
@@ -51,42 +78,41 @@ Board::~Board()
 
 void Board::setRwLine(WireState rwLine)
 {
-    if (rwLine == rwLine_)
-        return;
-    rwLine_ = rwLine;
-    emit signalChanged();
+    setControlLine(RwLine, rwLine);
 }
 
 void Board::setIrqLine(WireState irqLine)
 {
-    if (irqLine == irqLine_)
-        return;
-    irqLine_ = irqLine;
-    emit signalChanged();
+    setControlLine(IrqLine, irqLine);
 }
 
 void Board::setNmiLine(WireState nmiLine)
 {
-    if (nmiLine == nmiLine_)
-        return;
-    nmiLine_ = nmiLine;
-    emit signalChanged();
+    setControlLine(NmiLine, nmiLine);
 }
 
 void Board::setResetLine(WireState resetLine)
 {
-    if (resetLine == resetLine_)
-        return;
-    resetLine_ = resetLine;
-    emit signalChanged();
+    setControlLine(ResetLine, resetLine);
 }
 
 void Board::setSyncLine(WireState syncLine)
 {
-    if (syncLine == syncLine_)
+    setControlLine(SyncLine, syncLine);
+}
+
+void Board::setControlLine(uint32_t line, WireState state)
+{
+    setControlLines(isHigh(state) ? line : 0u, line);
+    notifyControlLines();
+}
+
+void Board::notifyControlLines()
+{
+    if (controlLines_ == notifiedControlLines_)
         return;
-    syncLine_ = syncLine;
-    emit signalChanged();
+    notifiedControlLines_ = controlLines_;
+    EMIT_OBSERVED(observers_, signalChanged());
 }
 
 const QVector<Device*>& Board::devices() const
@@ -121,12 +147,13 @@ const QVector<Bus*>& Board::busses() const
 
 Device* Board::findDevice(int32_t address)
 {
-    for (auto& device : qAsConst(devices_))
-    {
-        if (address >= device->mapAddressStart() && address <= device->mapAddressEnd())
-            return device;
-    }
-    return nullptr;
+    if (address < 0 || address >= AddressSpaceSize)
+        return nullptr;
+
+    const auto index = decodeTable_[address];
+    if (index == 0)
+        return nullptr;
+    return devices_[index - 1];
 }
 
 void Board::reset(QVector<Device*> devices, QVector<Bus*> busses)
@@ -144,8 +171,14 @@ void Board::reset(QVector<Device*> devices, QVector<Bus*> busses)
     }
 
     QMetaObject::invokeMethod(this, [this, devices, busses]() {
+        selectedDevice_ = nullptr;
+        history_.clear();
+        // a recording covers the run of one board
+        if (inputLog_.isRecording())
+            inputLog_.startRecording(cycleCount_);
         qDeleteAll(devices_);
         devices_ = devices;
+        rebuildDecodeTable();
 
         qDeleteAll(busses_);
         busses_ = busses;
@@ -154,6 +187,545 @@ void Board::reset(QVector<Device*> devices, QVector<Bus*> busses)
     });
 }
 
+void Board::setRunSliceCycles(uint32_t cycles)
+{
+    runSliceCycles_ = qMax(cycles, uint32_t{1});
+}
+
+uint64_t Board::run(uint64_t cycles)
+{
+    return runUntil({}, cycles);
+}
+
+uint64_t Board::runUntil(const std::function<bool()>& predicate, uint64_t maxCycles)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    if (clock_->isRunning())
+    {
+        qWarning() << "Board cannot be run while the clock is running";
+        return 0;
+    }
+
+    clock_->clearStopRequest();
+
+    // finish a half stepped cycle first, so every run cycle starts with a falling edge
+    if (isLow(clock_->state()))
+        clock_->triggerEdge(StateEdge::Raising);
+
+    uint64_t executed = 0;
+    while (executed < maxCycles)
+    {
+        const uint64_t slice = qMin(maxCycles - executed, uint64_t{runSliceCycles_});
+        const uint64_t sliceExecuted = runCycles(slice, predicate);
+        executed += sliceExecuted;
+
+        if (sliceExecuted < slice)
+            break;
+
+        QCoreApplication::processEvents();
+
+        if (clock_->isStopRequested())
+            break;
+    }
+
+    return executed;
+}
+
+BoardSnapshot Board::saveSnapshot() const
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    return takeSnapshot(true);
+}
+
+BoardSnapshot Board::takeSnapshot(bool withMemories) const
+{
+    BoardSnapshot snapshot;
+
+    QDataStream stream{&snapshot.state_, QIODevice::WriteOnly};
+    stream << SnapshotVersion << static_cast<quint64>(cycleCount_) << controlLines_
+           << static_cast<quint64>(addressBus_->data()) << static_cast<quint64>(dataBus_->data())
+           << isHigh(clock_->state());
+
+    cpu_->saveState(stream);
+    debugger_->saveState(stream);
+
+    syncDevices();
+
+    for (auto device : qAsConst(devices_))
+    {
+        device->saveState(stream);
+
+        if (withMemories)
+        {
+            auto* memory = qobject_cast<Memory*>(device);
+            snapshot.memories_.append(memory ? memory->contents() : QVector<uint8_t>{});
+        }
+        snapshot.deviceNames_.append(device->name());
+    }
+
+    snapshot.valid_ = true;
+    return snapshot;
+}
+
+bool Board::restoreSnapshot(const BoardSnapshot& snapshot)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    if (clock_->isRunning())
+    {
+        qWarning() << "Snapshot cannot be restored while the clock is running";
+        return false;
+    }
+
+    QStringList deviceNames;
+    for (auto device : qAsConst(devices_))
+        deviceNames.append(device->name());
+
+    if (!snapshot.isValid() || snapshot.deviceNames_ != deviceNames)
+    {
+        qWarning() << "Snapshot does not match the board";
+        return false;
+    }
+
+    // check the memory sizes up front, so a mismatch leaves the board untouched
+    for (int i = 0; i < devices_.size() && !snapshot.memories_.isEmpty(); ++i)
+    {
+        auto* memory = qobject_cast<Memory*>(devices_[i]);
+        if (memory && memory->data().size() != snapshot.memories_.at(i).size())
+        {
+            qWarning() << "Snapshot memory size does not match" << memory->name();
+            return false;
+        }
+    }
+
+    if (!applySnapshot(snapshot))
+        return false;
+
+    // memory changed behind the back of the write log
+    history_.clear();
+    return true;
+}
+
+bool Board::applySnapshot(const BoardSnapshot& snapshot)
+{
+    QDataStream stream{snapshot.state_};
+
+    quint32 version{};
+    stream >> version;
+    if (version != SnapshotVersion)
+    {
+        qWarning() << "Unsupported snapshot version" << version;
+        return false;
+    }
+
+    quint64 cycleCount{};
+    quint64 address{};
+    quint64 data{};
+    bool clockHigh{};
+    stream >> cycleCount >> controlLines_ >> address >> data >> clockHigh;
+
+    cpu_->restoreState(stream);
+    debugger_->restoreState(stream);
+
+    blockCache_.clear();
+
+    bool contentsRestored = true;
+    for (int i = 0; i < devices_.size(); ++i)
+    {
+        devices_[i]->restoreState(stream);
+
+        auto* memory = qobject_cast<Memory*>(devices_[i]);
+        if (memory && !snapshot.memories_.isEmpty() && !memory->restoreContents(snapshot.memories_.at(i)))
+            contentsRestored = false;
+    }
+
+    if (stream.status() != QDataStream::Ok || !contentsRestored)
+        qWarning() << "Snapshot is corrupt, board state is undefined";
+
+    cycleCount_ = cycleCount;
+    addressBus_->setData(address);
+    dataBus_->setData(data);
+    clock_->restoreState(clockHigh ? WireState::High : WireState::Low);
+
+    rescheduleDevices();
+    selectDevice(findDevice(addressBus_->typedData<uint16_t>()));
+    notifyControlLines();
+
+    return stream.status() == QDataStream::Ok && contentsRestored;
+}
+
+void Board::setInstructionStepping(bool instructionStepping)
+{
+    instructionStepping_ = instructionStepping;
+}
+
+void Board::setBlockCaching(bool blockCaching)
+{
+    blockCaching_ = blockCaching;
+}
+
+void Board::invalidateCode()
+{
+    QMetaObject::invokeMethod(this, [this]() { blockCache_.clear(); });
+}
+
+void Board::setHistoryEnabled(bool historyEnabled)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    history_.setEnabled(historyEnabled);
+}
+
+bool Board::seek(uint64_t cycle)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    if (clock_->isRunning())
+    {
+        qWarning() << "Board cannot seek while the clock is running";
+        return false;
+    }
+
+    if (cycle < cycleCount_)
+    {
+        uint64_t checkpointCycle{};
+        const auto* snapshot = history_.rewind(cycle, checkpointCycle);
+        if (!snapshot)
+        {
+            qWarning() << "Cycle" << cycle << "is not in the history";
+            return false;
+        }
+
+        if (!applySnapshot(*snapshot))
+            return false;
+        Q_ASSERT(cycleCount_ == checkpointCycle);
+    }
+
+    // the replay must not stop at breakpoints on the way
+    debugger_->setReplaying(true);
+    run(cycle - cycleCount_);
+    debugger_->setReplaying(false);
+
+    return cycleCount_ == cycle;
+}
+
+void Board::takeCheckpoint()
+{
+    history_.addCheckpoint(cycleCount_, takeSnapshot(false));
+}
+
+uint64_t Board::runCycles(uint64_t cycles, const std::function<bool()>& predicate)
+{
+    uint64_t cycle = 0;
+    while (cycle < cycles)
+    {
+        if (history_.needsCheckpoint(cycleCount_))
+            takeCheckpoint();
+
+        if (clock_->isStopRequested() || (predicate && predicate()))
+        {
+            notifyControlLines();
+            return cycle;
+        }
+
+        if (inputLog_.nextReplayCycle() <= cycleCount_)
+            replayInputs();
+
+        // stepping never overshoots the requested cycles or a replayed input and leaves the cycles
+        // a device may raise an interrupt in to the cycle accurate path
+        if (instructionStepping_ && cycles - cycle >= MaxInstructionCycles &&
+            inputLog_.nextReplayCycle() - cycleCount_ >= MaxInstructionCycles && !debugger_->isObserved() &&
+            devicesQuietFor(MaxInstructionCycles))
+        {
+            const auto stepped = stepInstruction();
+            if (stepped > 0)
+            {
+                cycle += stepped;
+                continue;
+            }
+        }
+
+        clockEdge(StateEdge::Falling);
+        clockEdge(StateEdge::Raising);
+        ++cycle;
+    }
+
+    notifyControlLines();
+
+    return cycles;
+}
+
+uint32_t Board::stepInstruction()
+{
+    const auto result = [this]() {
+        ScopedTiming timing{cpuTiming_};
+        return cpu_->stepInstruction();
+    }();
+    if (result.cycles == 0)
+        return 0;
+
+    if (result.accessPending)
+    {
+        // all but the last cycle only touched memory, the last one is completed on the busses
+        tickDevices(result.cycles - 1);
+        devicesEdge(StateEdge::Falling);
+        clockEdge(StateEdge::Raising);
+    }
+    else
+    {
+        tickDevices(result.cycles);
+
+        ScopedTiming timing{debuggerTiming_};
+        debugger_->handleInstructionStart(addressBus_->typedData<uint16_t>(), cpu_->currentOpcode());
+    }
+
+    return result.cycles;
+}
+
+bool Board::devicesQuietFor(uint64_t cycles) const
+{
+    // the devices are only ticked after a stepped instruction, while the core samples the
+    // interrupt lines in every cycle; sleeping devices leave the lines released
+    if (awakeDevices_ > 0)
+        return false;
+
+    // a device waking on the falling edge 2 * n is ticked in the cycle ending at count n + 1
+    return wakeQueue_.isEmpty() || wakeQueue_.front().edge / 2 >= cycleCount_ + cycles;
+}
+
+void Board::postInput(Device* device, uint8_t channel, uint32_t value)
+{
+    QMetaObject::invokeMethod(this, [this, device = QPointer<Device>{device}, toBoard = !device, channel, value]() {
+        const auto index = toBoard ? -1 : devices_.indexOf(device.data());
+        if (!toBoard && index < 0)
+            return;
+
+        applyInput(index, channel, value);
+    });
+}
+
+void Board::applyInput(int32_t device, uint8_t channel, uint32_t value)
+{
+    if (inputLog_.isRecording())
+        inputLog_.record(cycleCount_, device, channel, value);
+
+    if (device >= 0)
+    {
+        devices_[device]->applyInput(channel, value);
+        return;
+    }
+
+    if (channel == ResetInput)
+        setResetLine(toState(value));
+}
+
+void Board::replayInputs()
+{
+    while (inputLog_.nextReplayCycle() <= cycleCount_)
+    {
+        const auto input = inputLog_.takeReplayInput();
+        if (input.device >= devices_.size())
+        {
+            qWarning() << "Replayed input for unknown device" << input.device;
+            continue;
+        }
+
+        applyInput(input.device, input.channel, input.value);
+    }
+}
+
+void Board::tickDevices(uint32_t cycles)
+{
+    // the cpu only accessed memory in these cycles
+    selectDevice(nullptr);
+
+    const auto end = cycleCount_ + cycles;
+    while (cycleCount_ < end)
+    {
+        if (awakeDevices_ == 0 && (controlLines_ & ResetLine))
+        {
+            // all devices sleep, jump to the cycle the next one wakes in
+            setControlLines(IrqLine | NmiLine, IrqLine | NmiLine);
+
+            const auto wakeCycle = wakeQueue_.isEmpty() ? end : wakeQueue_.front().edge / 2;
+            if (wakeCycle > cycleCount_)
+            {
+                cycleCount_ = qMin(wakeCycle, end);
+                continue;
+            }
+        }
+
+        tickScheduledDevices(StateEdge::Falling);
+        ++cycleCount_;
+        tickScheduledDevices(StateEdge::Raising);
+    }
+}
+
+void Board::tickScheduledDevices(StateEdge edge)
+{
+    setControlLines(IrqLine | NmiLine, IrqLine | NmiLine);
+
+    const auto edgeIndex = isRaising(edge) ? 2 * cycleCount_ - 1 : 2 * cycleCount_;
+    wakeDueDevices(edgeIndex);
+
+    if (dispatchBound_)
+    {
+        dispatch_->tickDevices(this, edge, edgeIndex);
+        return;
+    }
+
+    // a device woken by another one on this edge is ticked on it when it comes later in order
+    for (auto device : qAsConst(tickingDevices_))
+    {
+        if (!device->sleeping_)
+            tickDevice(device, edge, edgeIndex);
+    }
+}
+
+void Board::sleepDevice(Device* device, uint64_t cycle)
+{
+    device->sleeping_ = true;
+    --awakeDevices_;
+
+    if (cycle == Device::NoEvent)
+    {
+        device->wakeEdge_ = Device::NoEvent;
+        return;
+    }
+
+    // wake on the falling edge of the cycle
+    device->wakeEdge_ = 2 * (cycle - 1);
+
+    // drop the stale entries once they pile up
+    if (wakeQueue_.size() > 4 * tickingDevices_.size())
+    {
+        wakeQueue_.clear();
+        for (auto sleeping : qAsConst(tickingDevices_))
+        {
+            if (sleeping->sleeping_ && sleeping->wakeEdge_ != Device::NoEvent && sleeping != device)
+                wakeQueue_.append({sleeping->wakeEdge_, sleeping});
+        }
+        std::make_heap(wakeQueue_.begin(), wakeQueue_.end(), std::greater<ScheduledWake>{});
+    }
+
+    wakeQueue_.append({device->wakeEdge_, device});
+    std::push_heap(wakeQueue_.begin(), wakeQueue_.end(), std::greater<ScheduledWake>{});
+}
+
+QVector<Instrumentation::Entry> Board::timingStats() const
+{
+    QVector<Instrumentation::Entry> entries;
+    entries.append(Instrumentation::entry(QStringLiteral("CPU"), cpuTiming_));
+    for (const auto* device : devices_)
+    {
+        const auto name = QStringLiteral("%1 (%2)").arg(device->name(),
+                                                        QString::fromUtf8(device->metaObject()->className()));
+        entries.append(Instrumentation::entry(name, device->timing_));
+    }
+    entries.append(Instrumentation::entry(QStringLiteral("Debugger"), debuggerTiming_));
+    entries.append(Instrumentation::signalEntries());
+    return entries;
+}
+
+void Board::resetTimingStats()
+{
+    cpuTiming_.reset();
+    for (auto* device : qAsConst(devices_))
+        device->timing_.reset();
+    debuggerTiming_.reset();
+    Instrumentation::resetSignals();
+}
+
+void Board::wakeDevice(Device* device)
+{
+    if (!device->sleeping_)
+        return;
+
+    device->sleeping_ = false;
+    ++awakeDevices_;
+}
+
+void Board::setDispatch(BoardDispatch* dispatch)
+{
+    dispatch_.reset(dispatch);
+    dispatchBound_ = dispatch_ && dispatch_->bind(devices_);
+
+    if (dispatch_ && !dispatchBound_)
+        qWarning() << "Static dispatch does not match the board devices, using the generic one";
+}
+
+void Board::wakeDueDevices(uint64_t edgeIndex)
+{
+    if (!(controlLines_ & ResetLine) && awakeDevices_ < tickingDevices_.size())
+    {
+        for (auto device : qAsConst(tickingDevices_))
+            wakeDevice(device);
+    }
+
+    while (!wakeQueue_.isEmpty() && wakeQueue_.front().edge <= edgeIndex)
+    {
+        const auto wake = wakeQueue_.front();
+        std::pop_heap(wakeQueue_.begin(), wakeQueue_.end(), std::greater<ScheduledWake>{});
+        wakeQueue_.removeLast();
+
+        if (wake.device->wakeEdge_ == wake.edge)
+            wakeDevice(wake.device);
+    }
+}
+
+void Board::rescheduleDevices()
+{
+    const auto nextEdge = 2 * cycleCount_ + (isLow(clock_->state()) ? 1 : 0);
+
+    wakeQueue_.clear();
+    for (auto device : qAsConst(tickingDevices_))
+    {
+        device->nextEdge_ = nextEdge;
+        device->sleeping_ = false;
+    }
+    awakeDevices_ = tickingDevices_.size();
+
+    // wire the busses to the devices they wake
+    QHash<Bus*, QVector<Device*>> connectedDevices;
+    for (auto device : qAsConst(devices_))
+    {
+        for (const auto& bc : device->busConnections())
+            connectedDevices[bc.bus()].append(device);
+    }
+    for (auto it = connectedDevices.cbegin(); it != connectedDevices.cend(); ++it)
+        it.key()->setConnectedDevices(it.value());
+}
+
+void Board::syncDevices() const
+{
+    // brings sleeping devices up to date without waking them
+    const auto nextEdge = 2 * cycleCount_ + (isLow(clock_->state()) ? 1 : 0);
+
+    for (auto device : qAsConst(tickingDevices_))
+    {
+        if (device->nextEdge_ >= nextEdge)
+            continue;
+
+        const auto raisingEdges = nextEdge / 2 - device->nextEdge_ / 2;
+        device->catchUp(raisingEdges, nextEdge - device->nextEdge_ - raisingEdges);
+        device->nextEdge_ = nextEdge;
+    }
+}
+
+void Board::connectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&Board::signalChanged))
+        observers_.add();
+}
+
+void Board::disconnectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&Board::signalChanged))
+        observers_.remove();
+}
+
 void Board::onClockCycleChanged()
 {
     StateEdge edge{StateEdge::Invalid};
@@ -169,15 +741,181 @@ void Board::onClockCycleChanged()
             break;
     }
 
-    cpu_->clockEdge(edge);
+    clockEdge(edge);
 
-    setIrqLine(WireState::High);
-    setNmiLine(WireState::High);
+    if (isRaising(edge) && history_.needsCheckpoint(cycleCount_))
+        takeCheckpoint();
 
-    for (auto device : qAsConst(devices_))
+    if (isRaising(edge) && inputLog_.nextReplayCycle() <= cycleCount_)
+        replayInputs();
+
+    notifyControlLines();
+}
+
+void Board::clockEdge(StateEdge edge)
+{
+    if (isRaising(edge))
+        cycleCount_++;
+
+    {
+        ScopedTiming timing{cpuTiming_};
+        cpu_->clockEdge(edge);
+    }
+
+    devicesEdge(edge);
+}
+
+void Board::devicesEdge(StateEdge edge)
+{
+    const auto address = addressBus_->typedData<uint16_t>();
+    selectDevice(dispatchBound_ ? dispatch_->decode(address) : findDevice(address));
+
+    // the value a write replaces is only known for memories
+    const bool watched = debugger_->hasWatchpoints() && isRaising(edge) && debugger_->watchFlags(address);
+    Memory* watchedMemory = watched ? qobject_cast<Memory*>(selectedDevice_) : nullptr;
+    const uint8_t oldValue = watchedMemory ? watchedMemory->byte(address - watchedMemory->mapAddressStart()) : 0;
+
+    if (selectedDevice_)
     {
-        device->clockEdge(edge);
+        if (!selectedDevice_->needsClockTick())
+        {
+            if (!cpu_->lastAccessWasDirect())
+            {
+                ScopedTiming timing{selectedDevice_->timing_};
+                selectedDevice_->clockEdge(edge);
+            }
+        }
+        else
+        {
+            wakeDevice(selectedDevice_);
+        }
     }
 
+    tickScheduledDevices(edge);
+
+    if (watched)
+        checkWatchpoints(address, watchedMemory, oldValue);
+
+    ScopedTiming timing{debuggerTiming_};
     debugger_->handleClockEdge(edge);
 }
+
+void Board::checkWatchpoints(uint16_t address, Memory* memory, uint8_t oldValue)
+{
+    const bool write = !(controlLines_ & RwLine);
+    if (write && memory)
+    {
+        // roms ignore the write, so the memory tells the written value
+        debugger_->handleWatchedAccess(address, true, memory->byte(address - memory->mapAddressStart()), oldValue);
+        return;
+    }
+
+    debugger_->handleWatchedAccess(address, write, dataBus_->typedData<uint8_t>(), std::nullopt);
+}
+
+void Board::selectDevice(Device* device)
+{
+    if (device == selectedDevice_)
+        return;
+
+    if (selectedDevice_)
+        selectedDevice_->setSelected(false);
+
+    selectedDevice_ = device;
+
+    if (selectedDevice_)
+        selectedDevice_->setSelected(true);
+}
+
+void Board::rebuildDecodeTable()
+{
+    blockCache_.clear();
+    decodeTable_.fill(0);
+    tickingDevices_.clear();
+
+    if (devices_.size() > std::numeric_limits<uint8_t>::max())
+        qWarning() << "Board has more devices than the decode table can address";
+
+    // walk backwards so the first device wins on overlapping ranges
+    for (auto i = qMin(devices_.size(), int{std::numeric_limits<uint8_t>::max()}); i > 0; --i)
+    {
+        const Device* device = devices_[i - 1];
+        const auto start = qMax(device->mapAddressStart(), 0);
+        const auto end = qMin(device->mapAddressEnd(), AddressSpaceSize - 1);
+        for (auto address = start; address <= end; ++address)
+            decodeTable_[address] = static_cast<uint8_t>(i);
+    }
+
+    for (auto device : qAsConst(devices_))
+    {
+        if (device->needsClockTick())
+            tickingDevices_.append(device);
+    }
+    rescheduleDevices();
+
+    dispatchBound_ = dispatch_ && dispatch_->bind(devices_);
+
+    // only pages owned completely by one memory can be accessed directly
+    for (int32_t page = 0; page < directPages_.size(); ++page)
+    {
+        const auto pageStart = page * PageSize;
+        const auto index = decodeTable_[pageStart];
+
+        DirectPage directPage{nullptr, 0, directPages_[page].watched};
+        if (index != 0 && std::all_of(decodeTable_.cbegin() + pageStart, decodeTable_.cbegin() + pageStart + PageSize,
+                                      [index](uint8_t i) { return i == index; }))
+        {
+            if (auto* memory = qobject_cast<Memory*>(devices_[index - 1]))
+            {
+                directPage.memory = memory;
+                directPage.offset = pageStart - memory->mapAddressStart();
+            }
+        }
+        directPages_[page] = directPage;
+    }
+}
+
+bool Board::readDirect(uint16_t address, uint8_t& data) const
+{
+    const auto& page = directPages_.at(address / PageSize);
+    if (!page.memory || page.watched || page.memory->isObserved())
+        return false;
+
+    data = page.memory->byte(page.offset + address % PageSize);
+    return true;
+}
+
+bool Board::isDirect(uint16_t address) const
+{
+    const auto& page = directPages_.at(address / PageSize);
+    return page.memory && !page.watched && !page.memory->isObserved();
+}
+
+void Board::setWatchedAddresses(const QVector<uint8_t>& watchFlags)
+{
+    Q_ASSERT(watchFlags.size() == AddressSpaceSize);
+
+    for (int32_t page = 0; page < directPages_.size(); ++page)
+    {
+        const auto pageStart = watchFlags.cbegin() + page * PageSize;
+        directPages_[page].watched = std::any_of(pageStart, pageStart + PageSize, [](uint8_t flags) { return flags != 0; });
+    }
+
+    // the running block may be on a page watched now
+    blockCache_.clear();
+}
+
+bool Board::writeDirect(uint16_t address, uint8_t data)
+{
+    const auto& page = directPages_.at(address / PageSize);
+    if (!page.memory || page.watched || page.memory->isObserved())
+        return false;
+
+    if (page.memory->isWriteable())
+    {
+        const auto offset = page.offset + address % PageSize;
+        recordWrite(address, page.memory, offset, page.memory->byte(offset));
+        page.memory->data()[offset] = data;
+    }
+    return true;
+}
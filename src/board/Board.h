@@ -13,14 +13,25 @@
 
 #pragma once
 
+#include "BlockCache.h"
+#include "BoardSnapshot.h"
+#include "History.h"
+#include "InputLog.h"
+#include "Instrumentation.h"
+#include "ObserverRegistry.h"
 #include "WireState.h"
 #include <QObject>
+#include <QScopedPointer>
+#include <QVector>
+#include <functional>
 
+class BoardDispatch;
 class Bus;
 class Clock;
 class CPU;
 class Debugger;
 class Device;
+class Memory;
 class UserState;
 class QIODevice;
 
@@ -28,6 +39,20 @@ class Board : public QObject
 {
     Q_OBJECT
 
+public:
+    // packed control lines, a set bit means the line is high
+    static constexpr uint32_t RwLine = 1 << 0;
+    static constexpr uint32_t IrqLine = 1 << 1;
+    static constexpr uint32_t NmiLine = 1 << 2;
+    static constexpr uint32_t ResetLine = 1 << 3;
+    static constexpr uint32_t SyncLine = 1 << 4;
+
+    // input channels of the board itself for postInput(), devices number their own
+    static constexpr uint8_t ResetInput = 0;
+
+    // longest 6502 instruction including page crossing penalties
+    static constexpr uint32_t MaxInstructionCycles = 8;
+
 public:
     explicit Board(QObject* parent = {});
     ~Board() override;
@@ -38,19 +63,26 @@ public:
     Clock* clock() const { return clock_; }
     Debugger* debugger() const { return debugger_; }
 
-    WireState rwLine() const { return rwLine_; }
+    uint32_t controlLines() const { return controlLines_; }
+    // used on the hot path, signalChanged() is emitted once per executed batch of cycles
+    void setControlLines(uint32_t lines, uint32_t mask)
+    {
+        controlLines_ = (controlLines_ & ~mask) | (lines & mask);
+    }
+
+    WireState rwLine() const { return toState(controlLines_ & RwLine); }
     void setRwLine(WireState rwLine);
 
-    WireState irqLine() const { return irqLine_; }
+    WireState irqLine() const { return toState(controlLines_ & IrqLine); }
     void setIrqLine(WireState irqLine);
 
-    WireState nmiLine() const { return nmiLine_; }
+    WireState nmiLine() const { return toState(controlLines_ & NmiLine); }
     void setNmiLine(WireState nmiLine);
 
-    WireState resetLine() const { return resetLine_; }
+    WireState resetLine() const { return toState(controlLines_ & ResetLine); }
     void setResetLine(WireState resetLine);
 
-    WireState syncLine() const { return syncLine_; }
+    WireState syncLine() const { return toState(controlLines_ & SyncLine); }
     void setSyncLine(WireState syncLine);
 
     const QVector<Device*>& devices() const;
@@ -71,28 +103,210 @@ public:
 
     void reset(QVector<Device*> devices, QVector<Bus*> busses);
 
+    // serve a cpu access straight from memory, bypassing the device model; both return false
+    // when the page is not backed by a single memory or that memory is observed
+    bool readDirect(uint16_t address, uint8_t& data) const;
+    bool writeDirect(uint16_t address, uint8_t data);
+    bool isDirect(uint16_t address) const;
+
+    // pages holding an address with watch flags stay on the device path, see Debugger
+    void setWatchedAddresses(const QVector<uint8_t>& watchFlags);
+
+    uint64_t cycleCount() const { return cycleCount_; }
+
+    // number of cycles executed by run()/runUntil() before pending events are processed
+    uint32_t runSliceCycles() const { return runSliceCycles_; }
+    void setRunSliceCycles(uint32_t cycles);
+
+    // drive the board directly from the calling (board) thread, bypassing the clock timer;
+    // both return the number of executed cycles and stop early when the clock is stopped
+    uint64_t run(uint64_t cycles);
+    uint64_t runUntil(const std::function<bool()>& predicate,
+                      uint64_t maxCycles = std::numeric_limits<uint64_t>::max());
+
+    // whole board state including all memory contents, both only while the clock is stopped;
+    // restoring fails for snapshots of a differently built board
+    BoardSnapshot saveSnapshot() const;
+    bool restoreSnapshot(const BoardSnapshot& snapshot);
+
+    // executes whole instructions against directly accessible memory while running and only
+    // drives the busses cycle by cycle for I/O, interrupts or while a debugger view is open;
+    // the predicate of runUntil() is then checked per instruction
+    bool isInstructionStepping() const { return instructionStepping_; }
+    void setInstructionStepping(bool instructionStepping);
+
+    // while instruction stepping, executes decoded basic blocks instead of ticking the core
+    // where possible; enabled by default
+    bool isBlockCaching() const { return blockCaching_; }
+    void setBlockCaching(bool blockCaching);
+    BlockCache& blockCache() { return blockCache_; }
+
+    // drops all decoded code, needed after memory contents were changed from outside the cpu;
+    // can be called from any thread
+    void invalidateCode();
+
+    // records checkpoints and memory writes while running, so seek() can go backwards; the
+    // history is dropped on reset and snapshot restore, inputs from outside are not replayed
+    bool isHistoryEnabled() const { return history_.isEnabled(); }
+    void setHistoryEnabled(bool historyEnabled);
+    History& history() { return history_; }
+    const History& history() const { return history_; }
+
+    // called by memories before every write the cpu issues
+    void recordWrite(uint16_t address, Memory* memory, int32_t offset, uint8_t oldValue)
+    {
+        blockCache_.invalidate(address);
+
+        if (history_.isRecording())
+            history_.recordWrite(memory, offset, oldValue);
+    }
+
+    // applies an input from outside the board, from any thread; it takes effect on the board
+    // thread at the start of a cycle and is recorded with it, see Device::applyInput(); a null
+    // device addresses the board's own inputs
+    void postInput(Device* device, uint8_t channel, uint32_t value);
+    InputLog& inputLog() { return inputLog_; }
+    const InputLog& inputLog() const { return inputLog_; }
+
+    // host time spent in the cpu, every device, the debugger and the observed signals while the
+    // Instrumentation is enabled, a signal also counts for the section emitting it; both from
+    // any thread
+    QVector<Instrumentation::Entry> timingStats() const;
+    void resetTimingStats();
+
+    // ticking devices sleep while idle, see Device::nextEventCycle(); wakes one for the next edge
+    void wakeDevice(Device* device);
+
+    // replaces the decode table and the virtual device calls with a dispatch compiled for one
+    // board, see StaticBoard.h; takes ownership and is only used while the devices match it
+    void setDispatch(BoardDispatch* dispatch);
+    bool isStaticDispatch() const { return dispatchBound_; }
+
+    // moves to the given cycle, backwards by restoring the nearest checkpoint and running
+    // forward from it; only while the clock is stopped
+    bool seek(uint64_t cycle);
+
 signals:
     void signalChanged();
     void resetted();
 
+protected:
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
+
 private slots:
     void onClockCycleChanged();
 
+private:
+    void setControlLine(uint32_t line, WireState state);
+    void notifyControlLines();
+    void clockEdge(StateEdge edge);
+    void devicesEdge(StateEdge edge);
+    void checkWatchpoints(uint16_t address, Memory* memory, uint8_t oldValue);
+    void tickDevices(uint32_t cycles);
+    void tickScheduledDevices(StateEdge edge);
+    template<typename T>
+    void tickDevice(T* device, StateEdge edge, uint64_t edgeIndex);
+    template<typename T>
+    void tickAwakeDevice(T* device, StateEdge edge, uint64_t edgeIndex)
+    {
+        if (!device->sleeping_)
+            tickDevice(device, edge, edgeIndex);
+    }
+    void sleepDevice(Device* device, uint64_t cycle);
+    void wakeDueDevices(uint64_t edgeIndex);
+    void rescheduleDevices();
+    void syncDevices() const;
+    uint32_t stepInstruction();
+    bool devicesQuietFor(uint64_t cycles) const;
+    void applyInput(int32_t device, uint8_t channel, uint32_t value);
+    void replayInputs();
+    void selectDevice(Device* device);
+    void rebuildDecodeTable();
+    BoardSnapshot takeSnapshot(bool withMemories) const;
+    bool applySnapshot(const BoardSnapshot& snapshot);
+    void takeCheckpoint();
+    uint64_t runCycles(uint64_t cycles, const std::function<bool()>& predicate);
+
+private:
+    struct DirectPage
+    {
+        Memory* memory;
+        int32_t offset;
+        bool watched;
+    };
+
+    struct ScheduledWake
+    {
+        // falling edge 2 * n and raising edge 2 * n + 1 belong to the cycle ending at count n + 1
+        uint64_t edge;
+        Device* device;
+
+        bool operator>(const ScheduledWake& other) const { return edge > other.edge; }
+    };
+
 private:
     Bus* addressBus_;
     Bus* dataBus_;
     QVector<Bus*> busses_;
     QVector<Device*> devices_;
-    WireState resetLine_;
-    WireState rwLine_;
-    WireState irqLine_;
-    WireState nmiLine_;
-    WireState syncLine_;
+    QVector<Device*> tickingDevices_;
+    // min-heap of the sleeping devices' wake edges, entries of devices woken early are stale
+    QVector<ScheduledWake> wakeQueue_;
+    int32_t awakeDevices_;
+    // maps every address to the index + 1 of the owning device in devices_, 0 means unmapped
+    QVector<uint8_t> decodeTable_;
+    Device* selectedDevice_;
+    QVector<DirectPage> directPages_;
+    uint32_t controlLines_;
+    uint32_t notifiedControlLines_;
+    uint64_t cycleCount_;
+    uint32_t runSliceCycles_;
+    bool instructionStepping_;
+    bool blockCaching_;
+    BlockCache blockCache_;
+    History history_;
+    InputLog inputLog_;
+    ObserverRegistry observers_;
+    QScopedPointer<BoardDispatch> dispatch_;
+    bool dispatchBound_;
 
     CPU* cpu_;
     Clock* clock_;
 
     Debugger* debugger_;
 
+    Instrumentation::Counter cpuTiming_;
+    Instrumentation::Counter debuggerTiming_;
+
+    template<typename... Devices>
+    friend class StaticBoard;
+
     Q_DISABLE_COPY_MOVE(Board)
 };
+
+// called with the concrete device types by static dispatches, so the device calls are resolved
+// at compile time
+template<typename T>
+void Board::tickDevice(T* device, StateEdge edge, uint64_t edgeIndex)
+{
+    ScopedTiming timing{device->timing_};
+
+    if (device->nextEdge_ < edgeIndex)
+    {
+        // raising edges have odd indices
+        const auto raisingEdges = edgeIndex / 2 - device->nextEdge_ / 2;
+        device->catchUp(raisingEdges, edgeIndex - device->nextEdge_ - raisingEdges);
+    }
+
+    device->deviceClockEdge(edge);
+    device->nextEdge_ = edgeIndex + 1;
+
+    // everything resets while the reset line is low
+    if (isRaising(edge) && (controlLines_ & ResetLine))
+    {
+        const auto cycle = device->nextEventCycle();
+        if (cycle > cycleCount_ + 1)
+            sleepDevice(device, cycle);
+    }
+}
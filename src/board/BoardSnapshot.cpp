@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BoardSnapshot.h"
+
+#include <QDataStream>
+
+namespace {
+
+constexpr quint32 FileMagic = 0x36353032; // "6502"
+
+} // namespace
+
+qint64 BoardSnapshot::size() const
+{
+    qint64 result = state_.size();
+    for (const auto& memory : memories_)
+        result += memory.size();
+    return result;
+}
+
+QDataStream& operator<<(QDataStream& stream, const BoardSnapshot& snapshot)
+{
+    stream << FileMagic << snapshot.valid_ << snapshot.deviceNames_ << snapshot.state_ << snapshot.memories_;
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, BoardSnapshot& snapshot)
+{
+    quint32 magic{};
+    stream >> magic;
+    if (magic != FileMagic)
+    {
+        stream.setStatus(QDataStream::ReadCorruptData);
+        snapshot = {};
+        return stream;
+    }
+
+    stream >> snapshot.valid_ >> snapshot.deviceNames_ >> snapshot.state_ >> snapshot.memories_;
+    if (stream.status() != QDataStream::Ok)
+        snapshot = {};
+    return stream;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+class QDataStream;
+
+// State of a whole board as taken by Board::saveSnapshot(). Memory contents are implicitly
+// shared with the board, so taking a snapshot copies nothing and a memory is only copied
+// once the board writes to it.
+class BoardSnapshot
+{
+public:
+    bool isValid() const { return valid_; }
+
+    const QStringList& deviceNames() const { return deviceNames_; }
+
+    // bytes held, counting shared memory contents as well
+    qint64 size() const;
+
+private:
+    bool valid_{false};
+    QStringList deviceNames_;
+    // cpu, debugger and device states
+    QByteArray state_;
+    // contents per device, empty for everything not being a memory
+    QVector<QVector<uint8_t>> memories_;
+
+    friend class Board;
+    friend QDataStream& operator<<(QDataStream& stream, const BoardSnapshot& snapshot);
+    friend QDataStream& operator>>(QDataStream& stream, BoardSnapshot& snapshot);
+};
+
+QDataStream& operator<<(QDataStream& stream, const BoardSnapshot& snapshot);
+QDataStream& operator>>(QDataStream& stream, BoardSnapshot& snapshot);
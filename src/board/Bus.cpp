@@ -14,11 +14,15 @@
 #include "Bus.h"
 
 #include "Board.h"
+#include "Device.h"
+#include <QMetaMethod>
 
 Bus::Bus(const QString& name, uint8_t width, Board* board) :
     QObject{nullptr},
     width_{width},
-    data_{}
+    data_{},
+    generation_{1},
+    connectedDevices_{}
 {
     assert(width_ == 8 || width_ == 16 || width_ == 32 || width_ == 64);
     setObjectName(name);
@@ -35,7 +39,16 @@ void Bus::setBit(uint8_t bit, WireState state)
     assert(bit < width_);
     uint64_t val = (isHigh(state) ? 1ULL : 0ULL) << bit;
     uint64_t mask = ~(1ULL << bit);
-    data_ = (data_ & mask) | val;
+    uint64_t newData = (data_ & mask) | val;
+
+    if (newData == data_)
+        return;
+
+    data_ = newData;
+    ++generation_;
+
+    for (auto device : qAsConst(connectedDevices_))
+        device->wake();
 }
 
 void Bus::setData(uint64_t data)
@@ -48,7 +61,7 @@ void Bus::setData(uint64_t data)
 
     data_ = newData;
 
-    emit dataChanged();
+    changed();
 }
 
 void Bus::setMaskedData(uint64_t data, uint64_t mask)
@@ -61,5 +74,27 @@ void Bus::setMaskedData(uint64_t data, uint64_t mask)
 
     data_ = newData;
 
-    emit dataChanged();
+    changed();
+}
+
+void Bus::changed()
+{
+    ++generation_;
+
+    for (auto device : qAsConst(connectedDevices_))
+        device->wake();
+
+    EMIT_OBSERVED(observers_, dataChanged());
+}
+
+void Bus::connectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&Bus::dataChanged))
+        observers_.add();
+}
+
+void Bus::disconnectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&Bus::dataChanged))
+        observers_.remove();
 }
@@ -13,10 +13,13 @@
 
 #pragma once
 
+#include "ObserverRegistry.h"
 #include "WireState.h"
 #include <QObject>
+#include <QVector>
 
 class Board;
+class Device;
 
 class Bus : public QObject
 {
@@ -35,15 +38,33 @@ public:
     T typedData() { return static_cast<T>(data_); }
 
     uint64_t data() const { return data_; }
+    // counts the changes of the data, starts at 1
+    uint64_t generation() const { return generation_; }
     void setData(uint64_t data);
 
     uint64_t maskedData(uint64_t mask) const { return data_ & mask; }
     void setMaskedData(uint64_t data, uint64_t mask);
 
+    // devices with a connection to this bus, woken by the board's scheduler on changes
+    void setConnectedDevices(const QVector<Device*>& devices) { connectedDevices_ = devices; }
+
+    // true while someone listens to dataChanged()
+    bool isObserved() const { return observers_.hasObservers(); }
+
 signals:
     void dataChanged();
 
+protected:
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
+
+private:
+    void changed();
+
 private:
     uint8_t width_;
     uint64_t data_;
+    uint64_t generation_;
+    ObserverRegistry observers_;
+    QVector<Device*> connectedDevices_;
 };
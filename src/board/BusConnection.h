@@ -13,10 +13,10 @@
 
 #pragma once
 
+#include "Bus.h"
+#include "utils/BitMapping.h"
 #include <cinttypes>
 
-class Bus;
-
 class BusConnection
 {
 public:
@@ -24,7 +24,10 @@ public:
         portTag_{portTag},
         portMask_{portMask},
         bus_{bus},
-        busMask_{busMask}
+        busMask_{busMask},
+        toPort_{busMask, portMask},
+        toBus_{portMask, busMask},
+        consumedGeneration_{}
     {
     }
 
@@ -33,9 +36,30 @@ public:
     Bus* bus() const { return bus_; }
     uint64_t busMask() const { return busMask_; }
 
+    // moves the wired bits between bus and port, other bits of the results are zero
+    uint64_t busToPort(uint64_t busData) const { return toPort_.map(busData); }
+    uint64_t portToBus(uint64_t portData) const { return toBus_.map(portData); }
+
+    // true when the bus changed since the last call, devices only inject changed inputs
+    bool takeChange()
+    {
+        const auto generation = bus_->generation();
+        if (generation == consumedGeneration_)
+            return false;
+
+        consumedGeneration_ = generation;
+        return true;
+    }
+
+    // the next takeChange() reports a change, for port state changed from elsewhere
+    void invalidate() { consumedGeneration_ = 0; }
+
 private:
     uint64_t portTag_;
     uint64_t portMask_;
     Bus* bus_;
     uint64_t busMask_;
+    BitMapping toPort_;
+    BitMapping toBus_;
+    uint64_t consumedGeneration_;
 };
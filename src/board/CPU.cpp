@@ -15,11 +15,15 @@
 
 #include "Board.h"
 #include "impl/m6502.h"
+#include <QDataStream>
+#include <QMetaMethod>
 
 CPU::CPU(Board* board) :
     QObject{board},
     board_{board},
-    chip_{new m6502_t}
+    chip_{new m6502_t},
+    pinState_{},
+    directAccess_{}
 {
     m6502_desc_t init;
     pinState_ = m6502_init(chip_, &init);
@@ -39,12 +43,34 @@ void CPU::clockEdge(StateEdge edge)
 
         pinState_ = m6502_tick(chip_, pinState_);
 
+        directAccess_ = accessDirect();
+
         populateState();
 
-        emit stepped();
+        EMIT_OBSERVED(observers_, stepped());
     }
 }
 
+void CPU::saveState(QDataStream& stream) const
+{
+    stream << chip_->IR << chip_->PC << chip_->AD << chip_->A << chip_->X << chip_->Y << chip_->S << chip_->P
+           << static_cast<quint64>(chip_->PINS) << chip_->irq_pip << chip_->nmi_pip << chip_->brk_flags
+           << static_cast<quint64>(pinState_) << directAccess_;
+}
+
+void CPU::restoreState(QDataStream& stream)
+{
+    quint64 chipPins{};
+    quint64 pinState{};
+    stream >> chip_->IR >> chip_->PC >> chip_->AD >> chip_->A >> chip_->X >> chip_->Y >> chip_->S >> chip_->P
+           >> chipPins >> chip_->irq_pip >> chip_->nmi_pip >> chip_->brk_flags
+           >> pinState >> directAccess_;
+    chip_->PINS = chipPins;
+    pinState_ = pinState;
+
+    EMIT_OBSERVED(observers_, stepped());
+}
+
 uint64_t CPU::registerA() const
 {
     return m6502_a(chip_);
@@ -80,32 +106,146 @@ uint64_t CPU::flags() const
     return m6502_p(chip_);
 }
 
-void CPU::setPinValue(uint64_t pin, WireState state)
+CPU::StepResult CPU::stepInstruction()
 {
-    if (isHigh(state))
-        pinState_ |= pin;
-    else if (isLow(state))
-        pinState_ &= ~pin;
+    if (!(pinState_ & M6502_SYNC))
+        return {};
+
+    injectState();
+
+    if (!canStepInstruction())
+        return {};
+
+    // a masked irq still has to be sampled by the core
+    if (board_->isBlockCaching() && !(pinState_ & M6502_IRQ))
+    {
+        const auto cycles = stepCached();
+        if (cycles > 0)
+            return {cycles, false};
+    }
+
+    StepResult result{};
+    do
+    {
+        pinState_ = m6502_tick(chip_, pinState_);
+        ++result.cycles;
+
+        directAccess_ = accessDirect();
+        if (!directAccess_)
+        {
+            result.accessPending = true;
+            break;
+        }
+    }
+    while (!(pinState_ & M6502_SYNC) && result.cycles < Board::MaxInstructionCycles);
+
+    // a jammed core never fetches the next opcode, the cycle path takes over with the last access
+    if (!(pinState_ & M6502_SYNC))
+        result.accessPending = true;
+
+    populateState();
+
+    EMIT_OBSERVED(observers_, stepped());
+
+    return result;
 }
 
-void CPU::injectState()
+uint32_t CPU::stepCached()
+{
+    BlockCache::Registers registers{chip_->PC, chip_->A, chip_->X, chip_->Y, chip_->S, chip_->P};
+    uint8_t opcode{};
+    const auto cycles = board_->blockCache().execute(board_, registers, chip_->bcd_enabled, opcode);
+    if (cycles == 0)
+        return 0;
+
+    chip_->IR = static_cast<uint16_t>(currentOpcode() << 3 | (cycles & 0x7));
+    chip_->PC = registers.pc;
+    chip_->A = registers.a;
+    chip_->X = registers.x;
+    chip_->Y = registers.y;
+    chip_->S = registers.s;
+    chip_->P = registers.p;
+
+    // like the core after the opcode fetch of the next instruction
+    pinState_ |= M6502_RW | M6502_SYNC;
+    M6502_SET_ADDR(pinState_, registers.pc);
+    M6502_SET_DATA(pinState_, opcode);
+    chip_->PINS = pinState_;
+    directAccess_ = true;
+
+    populateState();
+
+    EMIT_OBSERVED(observers_, stepped());
+
+    return cycles;
+}
+
+uint8_t CPU::currentOpcode() const
+{
+    return M6502_GET_DATA(pinState_);
+}
+
+bool CPU::canStepInstruction() const
+{
+    if (pinState_ & (M6502_RES | M6502_NMI))
+        return false;
+    if ((pinState_ & M6502_IRQ) && !(chip_->P & M6502_IF))
+        return false;
+    // interrupts already on their way through the pipelines
+    return chip_->irq_pip == 0 && chip_->nmi_pip == 0 && chip_->brk_flags == 0;
+}
+
+bool CPU::accessDirect()
 {
-    setPinValue(M6502_RES, negate(board_->resetLine()));
-    setPinValue(M6502_IRQ, negate(board_->irqLine()));
-    setPinValue(M6502_NMI, negate(board_->nmiLine()));
+    const uint16_t address = M6502_GET_ADDR(pinState_);
+
+    if (pinState_ & M6502_RW)
+    {
+        uint8_t data{};
+        if (!board_->readDirect(address, data))
+            return false;
+        M6502_SET_DATA(pinState_, data);
+        return true;
+    }
+
+    return board_->writeDirect(address, M6502_GET_DATA(pinState_));
+}
 
-    if (isHigh(toState(pinState_ & M6502_RW)))
+void CPU::injectState()
+{
+    // the cpu inputs are active low
+    const uint32_t lines = ~board_->controlLines();
+    pinState_ = (pinState_ & ~(M6502_RES | M6502_IRQ | M6502_NMI)) |
+            ((lines & Board::ResetLine) ? M6502_RES : 0) |
+            ((lines & Board::IrqLine) ? M6502_IRQ : 0) |
+            ((lines & Board::NmiLine) ? M6502_NMI : 0);
+
+    if (isHigh(toState(pinState_ & M6502_RW)) && !directAccess_)
         M6502_SET_DATA(pinState_, board_->dataBus()->data());
 }
 
 void CPU::populateState()
 {
-    board_->setResetLine(negate(toState(pinState_ & M6502_RES)));
-    board_->setRwLine(toState(pinState_ & M6502_RW));
-    board_->setSyncLine(toState(pinState_ & M6502_SYNC));
+    board_->setControlLines(((pinState_ & M6502_RES) ? 0 : Board::ResetLine) |
+                            ((pinState_ & M6502_RW) ? Board::RwLine : 0) |
+                            ((pinState_ & M6502_SYNC) ? Board::SyncLine : 0),
+                            Board::ResetLine | Board::RwLine | Board::SyncLine);
 
     board_->addressBus()->setData(M6502_GET_ADDR(pinState_));
 
-    if (isLow(toState(pinState_ & M6502_RW)))
+    // directly read data is still put on the bus, the debugger decodes opcodes from there
+    if (isLow(toState(pinState_ & M6502_RW)) || directAccess_)
         board_->dataBus()->setData(M6502_GET_DATA(pinState_));
 }
+
+void CPU::connectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&CPU::stepped))
+        observers_.add();
+}
+
+void CPU::disconnectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&CPU::stepped))
+        observers_.remove();
+}
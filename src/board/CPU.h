@@ -14,10 +14,12 @@
 #pragma once
 
 #include "Bus.h"
+#include "ObserverRegistry.h"
 #include "WireState.h"
 #include <QObject>
 
 class Board;
+class QDataStream;
 
 extern "C" {
 struct _m6502_t;
@@ -46,19 +48,48 @@ public:
     uint64_t registerIR() const;
     uint64_t flags() const;
 
+    // the access of the current cycle was served from memory without the device model
+    bool lastAccessWasDirect() const { return directAccess_; }
+
+    struct StepResult
+    {
+        uint32_t cycles;
+        // the last cycle is completed on the busses, its access is served through the devices
+        // unless it already was served directly
+        bool accessPending;
+    };
+
+    // runs the core up to the next instruction start, but at most Board::MaxInstructionCycles,
+    // without any bus traffic, as long as all accesses can be served directly; returns zero
+    // cycles when not at an instruction start or when an interrupt or reset is pending, which
+    // need the cycle accurate path
+    StepResult stepInstruction();
+    uint8_t currentOpcode() const;
+
+    void saveState(QDataStream& stream) const;
+    void restoreState(QDataStream& stream);
+
 signals:
     void stepped();
 
+protected:
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
+
 private:
-    void setPinValue(uint64_t pin, WireState state);
+    bool accessDirect();
+    uint32_t stepCached();
 
     void injectState();
     void populateState();
+    bool canStepInstruction() const;
 
 private:
     Board* board_;
     m6502_t* chip_;
     uint64_t pinState_;
+    bool directAccess_;
+    ObserverRegistry observers_;
 
     Q_DISABLE_COPY_MOVE(CPU)
 };
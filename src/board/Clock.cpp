@@ -16,47 +16,109 @@
 #include <QTimer>
 #include <QThread>
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <ctime>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+namespace {
+
+constexpr int64_t NsPerSecond = 1000000000;
+constexpr int64_t NsPerMillisecond = 1000000;
+
+// up to this frequency every edge is driven by the timer so it can be watched
+constexpr double MaxEdgeFrequency = 1000.0;
+// emulated time covered by one batch, keeps the event loop responsive
+constexpr double BatchDuration = 0.001;
+constexpr uint64_t UnlimitedBatchCycles = 20000;
+// when lagging further behind the pacing is restarted instead of catching up
+constexpr int64_t MaxPaceLag = NsPerSecond / 20;
+
+int64_t monotonicNow()
+{
+#ifdef Q_OS_UNIX
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t{ts.tv_sec} * NsPerSecond + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void sleepUntil(int64_t deadline)
+{
+#ifdef Q_OS_UNIX
+    timespec ts{};
+    ts.tv_sec = static_cast<time_t>(deadline / NsPerSecond);
+    ts.tv_nsec = static_cast<long>(deadline % NsPerSecond);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR);
+#else
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point{std::chrono::nanoseconds{deadline}});
+#endif
+}
+
+} // namespace
 
 Clock::Clock(QObject* parent) :
     QObject{parent},
-    period_{0},
-    busyWaiter_{},
-    busyWaitTimeout_{0},
+    frequency_{-1.0},
+    cycleRunner_{},
     timer_{new QTimer{this}},
     state_{true},
     shouldStop_{0},
+    paceStart_{0},
+    paceCycles_{0},
+    paceEdges_{0},
     statsTimer_(new QTimer(this)),
-    statsCycleCounter_{}
+    statsStart_{monotonicNow()},
+    statsCycleCounter_{},
+    statsJitterSum_{},
+    statsJitterCount_{}
 {
+    timer_->setTimerType(Qt::PreciseTimer);
     connect(timer_, &QTimer::timeout, this, &Clock::tick);
 
     connect(statsTimer_, &QTimer::timeout, this, &Clock::collectStats);
     statsTimer_->start(1000);
 
-    setPeriod(1000);
+    setFrequency(1000.0);
 }
 
 Clock::~Clock()
 {
 }
 
-void Clock::setPeriod(int32_t period)
+void Clock::setCycleRunner(CycleRunner cycleRunner)
 {
-    if (period == period_)
+    cycleRunner_ = std::move(cycleRunner);
+    timer_->setInterval(0);
+}
+
+void Clock::setFrequency(double frequency)
+{
+    frequency = std::max(frequency, 0.0);
+    if (frequency == frequency_)
         return;
 
-    period_ = period;
-    if (period_ < 2000)
-    {
-        busyWaitTimeout_ = period_ / 2;
-        busyWaiter_.start();
-        timer_->setInterval(0);
-    }
-    else
-    {
-        busyWaitTimeout_ = 0;
-        timer_->setInterval(period_ / 2000);
-    }
+    frequency_ = frequency;
+    // edge mode rearms the timer for the next due edge on every tick
+    timer_->setInterval(0);
+
+    restartPacing();
+}
+
+void Clock::restoreState(WireState state)
+{
+    // no clockCycleChanged(), the board would execute an edge
+    if (!isRunning())
+        state_ = state;
 }
 
 bool Clock::isRunning() const
@@ -74,6 +136,7 @@ void Clock::start()
 
     if (!isRunning())
     {
+        restartPacing();
         timer_->start();
         emit runningChanged();
     }
@@ -106,19 +169,36 @@ void Clock::triggerEdge(StateEdge edge)
     }
 
     if (extraTick)
-        tick();
+        tickEdge();
 
-    tick();
+    tickEdge();
 }
 
 void Clock::tick()
 {
-    if (isRunning() && busyWaitTimeout_ > 0)
-    {
-        while (busyWaiter_.nsecsElapsed() / int64_t{1000} <= busyWaitTimeout_);
-        busyWaiter_.start();
-    }
+    // a half stepped cycle is completed edge wise before batching continues
+    if (isBatchMode() && isHigh(state_))
+        tickBatch();
+    else if (isBatchMode())
+        tickEdge();
+    else
+        tickEdges();
+}
 
+bool Clock::isBatchMode() const
+{
+    return cycleRunner_ && (frequency_ <= 0.0 || frequency_ > MaxEdgeFrequency);
+}
+
+uint64_t Clock::batchCycles() const
+{
+    if (frequency_ <= 0.0)
+        return UnlimitedBatchCycles;
+    return std::max(uint64_t{1}, static_cast<uint64_t>(std::llround(frequency_ * BatchDuration)));
+}
+
+void Clock::tickEdge()
+{
     state_ = isLow(state_) ? WireState::High : WireState::Low;
 
     if (isHigh(state_))
@@ -126,6 +206,100 @@ void Clock::tick()
 
     emit clockCycleChanged();
 
+    stopIfRequested();
+}
+
+void Clock::tickEdges()
+{
+    if (frequency_ <= 0.0)
+    {
+        tickEdge();
+        return;
+    }
+
+    // absolute deadlines as in batch mode; the timer is coarser than the edges, so every edge
+    // due by now is run, each with its own clockCycleChanged()
+    auto now = monotonicNow();
+    if (now - edgeDeadline(paceEdges_) > MaxPaceLag)
+    {
+        restartPacing();
+        now = paceStart_;
+    }
+    else if (edgeDeadline(paceEdges_) <= now)
+    {
+        statsJitterSum_ += now - edgeDeadline(paceEdges_);
+        statsJitterCount_++;
+    }
+
+    while (isRunning() && edgeDeadline(paceEdges_) <= now)
+    {
+        ++paceEdges_;
+        tickEdge();
+    }
+
+    if (isRunning())
+    {
+        const auto wait = std::max(int64_t{0}, edgeDeadline(paceEdges_) - monotonicNow());
+        timer_->setInterval(static_cast<int>((wait + NsPerMillisecond - 1) / NsPerMillisecond));
+    }
+}
+
+void Clock::tickBatch()
+{
+    const uint64_t cycles = cycleRunner_(batchCycles());
+
+    statsCycleCounter_ += cycles;
+    paceCycles_ += cycles;
+
+    if (shouldStop_)
+    {
+        stopIfRequested();
+        return;
+    }
+
+    pace();
+}
+
+void Clock::restartPacing()
+{
+    paceStart_ = monotonicNow();
+    paceCycles_ = 0;
+    paceEdges_ = 0;
+}
+
+// the first edge is due at the pacing start
+int64_t Clock::edgeDeadline(uint64_t edge) const
+{
+    return paceStart_ + static_cast<int64_t>(static_cast<double>(edge) * NsPerSecond / (2.0 * frequency_));
+}
+
+void Clock::pace()
+{
+    if (frequency_ <= 0.0)
+        return;
+
+    // absolute deadlines keep sleep inaccuracies from accumulating into drift
+    const auto deadline = paceStart_ +
+            static_cast<int64_t>(static_cast<double>(paceCycles_) * NsPerSecond / frequency_);
+    const auto now = monotonicNow();
+
+    if (now - deadline > MaxPaceLag)
+    {
+        restartPacing();
+        return;
+    }
+
+    if (deadline <= now)
+        return;
+
+    sleepUntil(deadline);
+
+    statsJitterSum_ += monotonicNow() - deadline;
+    statsJitterCount_++;
+}
+
+void Clock::stopIfRequested()
+{
     if (shouldStop_ && isHigh(state_))
     {
         timer_->stop();
@@ -135,7 +309,17 @@ void Clock::tick()
 
 void Clock::collectStats()
 {
-    emit statsUpdatedClockCycles(statsCycleCounter_);
+    const auto now = monotonicNow();
+    const auto elapsed = now - statsStart_;
+
+    const auto clockCycles = elapsed > 0 ?
+            std::llround(static_cast<double>(statsCycleCounter_) * NsPerSecond / static_cast<double>(elapsed)) : 0;
+    const auto jitter = statsJitterCount_ > 0 ? statsJitterSum_ / statsJitterCount_ : 0;
+
+    emit statsUpdatedClockCycles(static_cast<qint32>(clockCycles), static_cast<qint32>(jitter));
 
+    statsStart_ = now;
     statsCycleCounter_ = 0;
+    statsJitterSum_ = 0;
+    statsJitterCount_ = 0;
 }
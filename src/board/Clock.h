@@ -15,8 +15,8 @@
 
 #include "WireState.h"
 #include <QAtomicInt>
-#include <QElapsedTimer>
 #include <QObject>
+#include <functional>
 
 class QTimer;
 
@@ -24,18 +24,30 @@ class Clock : public QObject
 {
     Q_OBJECT
 
+public:
+    using CycleRunner = std::function<uint64_t(uint64_t cycles)>;
+
 public:
     explicit Clock(QObject* parent = {});
     ~Clock() override;
 
-    int32_t period() const { return period_; }
+    // emulated frequency in Hz, 0 means unlimited
+    double frequency() const { return frequency_; }
 
     bool isRunning() const;
+    bool isStopRequested() const { return shouldStop_.loadRelaxed() != 0; }
+    void clearStopRequest() { shouldStop_.storeRelaxed(0); }
 
     WireState state() const { return state_; }
+    // only while stopped, used when restoring board snapshots
+    void restoreState(WireState state);
+
+    // runs whole cycles in batches, used instead of single edges above 1 kHz and when unlimited;
+    // clockCycleChanged() is then not emitted for the batched edges
+    void setCycleRunner(CycleRunner cycleRunner);
 
 public slots:
-    void setPeriod(qint32 period);
+    void setFrequency(double frequency);
     void start();
     void stop();
     void triggerEdge(StateEdge edge);
@@ -43,22 +55,39 @@ public slots:
 signals:
     void runningChanged();
     void clockCycleChanged();
-    void statsUpdatedClockCycles(qint32 clockCycles);
+    void statsUpdatedClockCycles(qint32 clockCycles, qint32 jitter);
 
 private slots:
     void tick();
     void collectStats();
 
 private:
-    int32_t period_;
-    QElapsedTimer busyWaiter_;
-    int64_t busyWaitTimeout_;
+    bool isBatchMode() const;
+    uint64_t batchCycles() const;
+    void tickEdge();
+    void tickEdges();
+    void tickBatch();
+    void restartPacing();
+    void pace();
+    int64_t edgeDeadline(uint64_t edge) const;
+    void stopIfRequested();
+
+private:
+    double frequency_;
+    CycleRunner cycleRunner_;
     QTimer* timer_;
     WireState state_;
     QAtomicInt shouldStop_;
 
+    int64_t paceStart_;
+    uint64_t paceCycles_;
+    uint64_t paceEdges_;
+
     QTimer* statsTimer_;
-    int32_t statsCycleCounter_;
+    int64_t statsStart_;
+    uint64_t statsCycleCounter_;
+    int64_t statsJitterSum_;
+    int32_t statsJitterCount_;
 
     Q_DISABLE_COPY_MOVE(Clock)
 };
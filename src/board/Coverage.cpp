@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Coverage.h"
+
+#include "M6502Disassembler.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSet>
+#include <QXmlStreamWriter>
+
+namespace {
+
+constexpr int AddressCount = 0x10000;
+
+const QSet<QString>& mnemonics()
+{
+    static const QSet<QString> result = []() {
+        QSet<QString> set;
+        for (const auto& mnemonic : M6502::mnemonicList())
+            set.insert(mnemonic.toUpper());
+        return set;
+    }();
+    return result;
+}
+
+// the mnemonic after an optional label, empty for directives and data
+QString mnemonic(const QString& text)
+{
+    static const QRegularExpression codeExpression{QStringLiteral("^(?:[A-Za-z_.][\\w.]*:?)?\\s+([A-Za-z]+)\\b")};
+
+    const auto match = codeExpression.match(text);
+    if (!match.hasMatch())
+        return {};
+
+    const auto word = match.captured(1).toUpper();
+    return mnemonics().contains(word) ? word : QString{};
+}
+
+bool isBranch(const QString& mnemonic)
+{
+    static const QSet<QString> branches{
+        QStringLiteral("BPL"), QStringLiteral("BMI"), QStringLiteral("BVC"), QStringLiteral("BVS"),
+        QStringLiteral("BCC"), QStringLiteral("BCS"), QStringLiteral("BNE"), QStringLiteral("BEQ"),
+    };
+    return branches.contains(mnemonic);
+}
+
+QString rate(int covered, int valid)
+{
+    return QString::number(valid > 0 ? static_cast<double>(covered) / valid : 1.0, 'f', 4);
+}
+
+} // namespace
+
+Coverage::Coverage() :
+    enabled_{false},
+    executed_{AddressCount},
+    taken_{AddressCount},
+    notTaken_{AddressCount}
+{
+}
+
+void Coverage::clear()
+{
+    executed_.fill(false);
+    taken_.fill(false);
+    notTaken_.fill(false);
+}
+
+QVector<Coverage::Line> Coverage::lines(const QList<Program::SourceLine>& sourceLines) const
+{
+    QVector<Line> result;
+
+    for (int i = 0; i < sourceLines.size(); ++i)
+    {
+        const auto& sourceLine = sourceLines[i];
+        if (sourceLine.address < 0 || sourceLine.address >= AddressCount)
+            continue;
+
+        const auto word = mnemonic(sourceLine.text);
+        if (word.isEmpty())
+            continue;
+
+        const auto address = sourceLine.address;
+        result.append({i, isExecuted(address), isBranch(word), isBranchTaken(address), isBranchNotTaken(address)});
+    }
+
+    return result;
+}
+
+Coverage::Summary Coverage::summarize(const QVector<Line>& lines)
+{
+    Summary summary{};
+    for (const auto& line : lines)
+    {
+        summary.lines += 1;
+        summary.coveredLines += line.executed ? 1 : 0;
+
+        if (line.branch)
+        {
+            summary.branches += 2;
+            summary.coveredBranches += (line.taken ? 1 : 0) + (line.notTaken ? 1 : 0);
+        }
+    }
+    return summary;
+}
+
+QByteArray Coverage::toLcov(const QList<Program::SourceLine>& sourceLines, const QString& sourceFileName) const
+{
+    const auto coveredLines = lines(sourceLines);
+    const auto summary = summarize(coveredLines);
+
+    QByteArray result;
+    result += "TN:\nSF:" + sourceFileName.toUtf8() + '\n';
+
+    for (const auto& line : coveredLines)
+    {
+        if (!line.branch)
+            continue;
+
+        // lcov marks the branches of lines that never ran with '-'
+        const auto number = QByteArray::number(sourceLines[line.index].line);
+        const auto outcome = [&line](bool hit) -> QByteArray { return line.executed ? (hit ? "1" : "0") : "-"; };
+        result += "BRDA:" + number + ",0,0," + outcome(line.taken) + '\n';
+        result += "BRDA:" + number + ",0,1," + outcome(line.notTaken) + '\n';
+    }
+    result += "BRF:" + QByteArray::number(summary.branches) + '\n';
+    result += "BRH:" + QByteArray::number(summary.coveredBranches) + '\n';
+
+    for (const auto& line : coveredLines)
+    {
+        result += "DA:" + QByteArray::number(sourceLines[line.index].line) + ',' +
+                  (line.executed ? '1' : '0') + '\n';
+    }
+    result += "LF:" + QByteArray::number(summary.lines) + '\n';
+    result += "LH:" + QByteArray::number(summary.coveredLines) + '\n';
+    result += "end_of_record\n";
+
+    return result;
+}
+
+QByteArray Coverage::toCobertura(const QList<Program::SourceLine>& sourceLines, const QString& sourceFileName) const
+{
+    const auto coveredLines = lines(sourceLines);
+    const auto summary = summarize(coveredLines);
+    const auto lineRate = rate(summary.coveredLines, summary.lines);
+    const auto branchRate = rate(summary.coveredBranches, summary.branches);
+
+    QByteArray result;
+    QXmlStreamWriter xml{&result};
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement(QStringLiteral("coverage"));
+    xml.writeAttribute(QStringLiteral("line-rate"), lineRate);
+    xml.writeAttribute(QStringLiteral("branch-rate"), branchRate);
+    xml.writeAttribute(QStringLiteral("lines-covered"), QString::number(summary.coveredLines));
+    xml.writeAttribute(QStringLiteral("lines-valid"), QString::number(summary.lines));
+    xml.writeAttribute(QStringLiteral("branches-covered"), QString::number(summary.coveredBranches));
+    xml.writeAttribute(QStringLiteral("branches-valid"), QString::number(summary.branches));
+    xml.writeAttribute(QStringLiteral("complexity"), QStringLiteral("0"));
+    xml.writeAttribute(QStringLiteral("version"), QStringLiteral("6502emu"));
+    xml.writeAttribute(QStringLiteral("timestamp"), QString::number(QDateTime::currentSecsSinceEpoch()));
+
+    const auto name = QFileInfo{sourceFileName}.completeBaseName();
+    xml.writeStartElement(QStringLiteral("packages"));
+    xml.writeStartElement(QStringLiteral("package"));
+    xml.writeAttribute(QStringLiteral("name"), name);
+    xml.writeAttribute(QStringLiteral("line-rate"), lineRate);
+    xml.writeAttribute(QStringLiteral("branch-rate"), branchRate);
+    xml.writeAttribute(QStringLiteral("complexity"), QStringLiteral("0"));
+    xml.writeStartElement(QStringLiteral("classes"));
+    xml.writeStartElement(QStringLiteral("class"));
+    xml.writeAttribute(QStringLiteral("name"), name);
+    xml.writeAttribute(QStringLiteral("filename"), sourceFileName);
+    xml.writeAttribute(QStringLiteral("line-rate"), lineRate);
+    xml.writeAttribute(QStringLiteral("branch-rate"), branchRate);
+    xml.writeAttribute(QStringLiteral("complexity"), QStringLiteral("0"));
+    xml.writeEmptyElement(QStringLiteral("methods"));
+    xml.writeStartElement(QStringLiteral("lines"));
+
+    for (const auto& line : coveredLines)
+    {
+        xml.writeStartElement(QStringLiteral("line"));
+        xml.writeAttribute(QStringLiteral("number"), QString::number(sourceLines[line.index].line));
+        xml.writeAttribute(QStringLiteral("hits"), line.executed ? QStringLiteral("1") : QStringLiteral("0"));
+        xml.writeAttribute(QStringLiteral("branch"), line.branch ? QStringLiteral("true") : QStringLiteral("false"));
+        if (line.branch)
+        {
+            const int covered = (line.taken ? 1 : 0) + (line.notTaken ? 1 : 0);
+            xml.writeAttribute(QStringLiteral("condition-coverage"),
+                               QStringLiteral("%1% (%2/2)").arg(covered * 50).arg(covered));
+        }
+        xml.writeEndElement();
+    }
+
+    xml.writeEndDocument();
+
+    return result;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Program.h"
+#include <QBitArray>
+#include <QByteArray>
+#include <QVector>
+
+// Which instructions ran and which way every conditional branch went, fed by the Debugger with
+// every instruction start. One bit per address and outcome, cheap enough to stay on for whole
+// runs; it survives resets and is only dropped by clear().
+class Coverage
+{
+public:
+    struct Line
+    {
+        int32_t index; // into Program::sourceLines()
+        bool executed;
+        bool branch;
+        bool taken;
+        bool notTaken;
+    };
+
+    // a branch line has two outcomes
+    struct Summary
+    {
+        int lines;
+        int coveredLines;
+        int branches;
+        int coveredBranches;
+    };
+
+public:
+    Coverage();
+
+    bool isEnabled() const { return enabled_; }
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+
+    void clear();
+
+    void instructionStart(int32_t address, int32_t previousAddress, uint8_t previousOpcode)
+    {
+        executed_.setBit(address);
+
+        // bpl, bmi, bvc, bvs, bcc, bcs, bne and beq
+        if ((previousOpcode & 0x1F) == 0x10)
+        {
+            if (address == previousAddress + 2)
+                notTaken_.setBit(previousAddress);
+            else
+                taken_.setBit(previousAddress);
+        }
+    }
+
+    bool isExecuted(int32_t address) const { return executed_.testBit(address); }
+    bool isBranchTaken(int32_t address) const { return taken_.testBit(address); }
+    bool isBranchNotTaken(int32_t address) const { return notTaken_.testBit(address); }
+
+    // the source lines holding an instruction
+    QVector<Line> lines(const QList<Program::SourceLine>& sourceLines) const;
+    static Summary summarize(const QVector<Line>& lines);
+
+    // listings only know the line numbers, the source file name is written as given
+    QByteArray toLcov(const QList<Program::SourceLine>& sourceLines, const QString& sourceFileName) const;
+    QByteArray toCobertura(const QList<Program::SourceLine>& sourceLines, const QString& sourceFileName) const;
+
+private:
+    bool enabled_;
+    QBitArray executed_;
+    QBitArray taken_;
+    QBitArray notTaken_;
+};
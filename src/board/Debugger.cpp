@@ -17,9 +17,12 @@
 #include "Bus.h"
 #include "Clock.h"
 #include "M6502Disassembler.h"
+#include <QDataStream>
+#include <QMetaMethod>
 #include <QThread>
 #include <QTimer>
 #include <QDebug>
+#include <algorithm>
 
 Debugger::Debugger(Board* board) :
     QObject{board},
@@ -33,6 +36,7 @@ Debugger::Debugger(Board* board) :
     Q_ASSERT(rtsOpcode_ != 0xEA);
 
     callStack_.reserve(1024);
+    watchFlags_.fill(0, 0x10000);
 }
 
 Debugger::~Debugger()
@@ -65,6 +69,71 @@ void Debugger::stepSubroutine()
     }
 }
 
+void Debugger::reverseStepInstruction()
+{
+    if (!canTravel())
+        return;
+
+    if (lastInstructionCycle_ == currentInstructionCycle_)
+    {
+        qWarning() << "No previous instruction to step back to";
+        return;
+    }
+
+    board_->seek(lastInstructionCycle_);
+}
+
+void Debugger::reverseContinue()
+{
+    if (!canTravel())
+        return;
+
+    const History& history = board_->history();
+    const uint64_t origin = board_->cycleCount();
+
+    // search the intervals between checkpoints backwards, each one by replaying it
+    breakpointSearchEnd_ = origin;
+    while (const auto checkpointCycle = history.checkpointBefore(breakpointSearchEnd_))
+    {
+        lastBreakpointHit_.reset();
+        if (!board_->seek(*checkpointCycle) || !board_->seek(breakpointSearchEnd_))
+            break;
+
+        if (lastBreakpointHit_)
+            break;
+
+        breakpointSearchEnd_ = *checkpointCycle;
+    }
+    breakpointSearchEnd_ = 0;
+
+    if (lastBreakpointHit_)
+        board_->seek(*lastBreakpointHit_);
+    else if (history.checkpointCount() > 0)
+        board_->seek(history.checkpointCycle(0)); // like running into the start of the recorded history
+
+    lastBreakpointHit_.reset();
+}
+
+bool Debugger::canTravel() const
+{
+    if (replaying_)
+        return false;
+
+    if (board_->clock()->isRunning())
+    {
+        qWarning() << "Cannot travel back while the clock is running";
+        return false;
+    }
+
+    if (!board_->isHistoryEnabled())
+    {
+        qWarning() << "Board history is not enabled";
+        return false;
+    }
+
+    return true;
+}
+
 void Debugger::addBreakpoint(int32_t address)
 {
     Q_ASSERT(QThread::currentThread() == thread());
@@ -77,6 +146,66 @@ void Debugger::removeBreakpoint(int32_t address)
     breakpoints_.remove(address);
 }
 
+void Debugger::addWatchpoint(int32_t start, int32_t end, uint8_t flags)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    if (start < 0 || end > 0xFFFF || start > end)
+    {
+        qWarning() << "Invalid watchpoint range" << start << end;
+        return;
+    }
+
+    removeWatchpoint(start, end);
+    if (flags != 0)
+        watchpoints_.append({start, end, flags});
+    rebuildWatchFlags();
+}
+
+void Debugger::removeWatchpoint(int32_t start, int32_t end)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    watchpoints_.erase(std::remove_if(watchpoints_.begin(), watchpoints_.end(),
+                                      [start, end](const Watchpoint& watchpoint) {
+                                          return watchpoint.start == start && watchpoint.end == end;
+                                      }),
+                       watchpoints_.end());
+    rebuildWatchFlags();
+}
+
+void Debugger::rebuildWatchFlags()
+{
+    watchFlags_.fill(0);
+    for (const auto& watchpoint : qAsConst(watchpoints_))
+    {
+        for (auto address = watchpoint.start; address <= watchpoint.end; ++address)
+            watchFlags_[address] |= watchpoint.flags;
+    }
+
+    hasWatchpoints_ = !watchpoints_.isEmpty();
+    board_->setWatchedAddresses(watchFlags_);
+}
+
+void Debugger::handleWatchedAccess(uint16_t address, bool write, uint8_t value, std::optional<uint8_t> oldValue)
+{
+    const auto flags = watchFlags_[address];
+
+    bool hit = false;
+    if (write)
+        hit = (flags & WatchWrite) || ((flags & WatchChange) && (!oldValue || *oldValue != value));
+    else
+        hit = (flags & WatchRead) != 0;
+
+    if (!hit)
+        return;
+
+    watchpointHitPending_ = true;
+
+    if (!replaying_)
+        emit watchpointHit(address, write, value);
+}
+
 void Debugger::reset()
 {
     failState_ = false;
@@ -86,19 +215,54 @@ void Debugger::reset()
     lastInstructionStart_ = 0;
     currentInstruction_ = 0;
     currentInstructionStart_ = 0;
+    lastInstructionCycle_ = 0;
+    currentInstructionCycle_ = 0;
 
     callStack_.empty();
 
     steppingSubroutineCallStackStart_ = 0;
+    watchpointHitPending_ = false;
+
+    profiler_.restart();
+}
+
+void Debugger::saveState(QDataStream& stream) const
+{
+    stream << failState_ << lastInstruction_ << lastInstructionStart_ << currentInstruction_
+           << currentInstructionStart_ << static_cast<quint64>(lastInstructionCycle_)
+           << static_cast<quint64>(currentInstructionCycle_) << callStack_;
+}
+
+void Debugger::restoreState(QDataStream& stream)
+{
+    const bool wasFailState = failState_;
+
+    quint64 lastInstructionCycle{};
+    quint64 currentInstructionCycle{};
+    stream >> failState_ >> lastInstruction_ >> lastInstructionStart_ >> currentInstruction_
+           >> currentInstructionStart_ >> lastInstructionCycle >> currentInstructionCycle >> callStack_;
+    lastInstructionCycle_ = lastInstructionCycle;
+    currentInstructionCycle_ = currentInstructionCycle;
+    steppingMode_ = SteppingMode::None;
+    watchpointHitPending_ = false;
+    profiler_.restart();
+
+    if (failState_ != wasFailState)
+        emit failStateChanged();
+
+    EMIT_OBSERVED(observers_, newInstructionStart());
 }
 
-void Debugger::updateInstructionState(int32_t address)
+void Debugger::updateInstructionState(int32_t address, uint8_t opcode)
 {
     lastInstruction_ = currentInstruction_;
     lastInstructionStart_ = currentInstructionStart_;
 
-    currentInstruction_ = board_->dataBus()->typedData<uint8_t>();
+    lastInstructionCycle_ = currentInstructionCycle_;
+
+    currentInstruction_ = opcode;
     currentInstructionStart_ = address;
+    currentInstructionCycle_ = board_->cycleCount();
 }
 
 void Debugger::updateCallStack()
@@ -120,10 +284,26 @@ void Debugger::updateCallStack()
 
 void Debugger::stopAtBreakpoint(int32_t address)
 {
-    if (breakpointMatches(address))
-    {
+    if (!breakpointMatches(address))
+        return;
+
+    if (!replaying_)
         board_->clock()->stop();
-    }
+    else if (board_->cycleCount() < breakpointSearchEnd_)
+        lastBreakpointHit_ = board_->cycleCount();
+}
+
+void Debugger::stopAtWatchpoint()
+{
+    if (!watchpointHitPending_)
+        return;
+
+    watchpointHitPending_ = false;
+
+    if (!replaying_)
+        board_->clock()->stop();
+    else if (board_->cycleCount() < breakpointSearchEnd_)
+        lastBreakpointHit_ = board_->cycleCount();
 }
 
 void Debugger::stopAfterInstruction()
@@ -148,18 +328,26 @@ void Debugger::stopAfterSubroutine()
     }
 }
 
-void Debugger::handleNewInstructionStart()
+void Debugger::handleInstructionStart(int32_t address, uint8_t opcode)
 {
-    uint16_t address = board_->addressBus()->typedData<uint16_t>();
+    if (failState_)
+        return;
 
-    updateInstructionState(address);
+    updateInstructionState(address, opcode);
+    const auto callDepth = callStack_.size();
     updateCallStack();
 
+    if (coverage_.isEnabled())
+        coverage_.instructionStart(address, lastInstructionStart_, lastInstruction_);
+    if (profiler_.isEnabled())
+        profiler_.instructionStart(address, currentInstructionCycle_, callStack_.size() - callDepth);
+
     stopAtBreakpoint(address);
+    stopAtWatchpoint();
     stopAfterInstruction();
     stopAfterSubroutine();
 
-    emit newInstructionStart();
+    EMIT_OBSERVED(observers_, newInstructionStart());
 }
 
 void Debugger::enterFailState()
@@ -174,7 +362,9 @@ void Debugger::enterFailState()
 
 void Debugger::handleClockEdge(StateEdge edge)
 {
-    if (isLow(board_->resetLine()))
+    const uint32_t lines = board_->controlLines();
+
+    if (!(lines & Board::ResetLine))
     {
         reset();
         return;
@@ -183,8 +373,21 @@ void Debugger::handleClockEdge(StateEdge edge)
     if (failState_)
         return;
 
-    if (isRaising(edge) && isHigh(board_->syncLine()))
+    if (isRaising(edge) && (lines & Board::SyncLine))
     {
-        handleNewInstructionStart();
+        handleInstructionStart(board_->addressBus()->typedData<uint16_t>(),
+                               board_->dataBus()->typedData<uint8_t>());
     }
 }
+
+void Debugger::connectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&Debugger::newInstructionStart))
+        observers_.add();
+}
+
+void Debugger::disconnectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&Debugger::newInstructionStart))
+        observers_.remove();
+}
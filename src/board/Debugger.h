@@ -13,16 +13,28 @@
 
 #pragma once
 
+#include "Coverage.h"
+#include "ObserverRegistry.h"
+#include "Profiler.h"
 #include "WireState.h"
 #include <QObject>
 #include <QSet>
+#include <optional>
 
 class Board;
+class QDataStream;
 
 class Debugger : public QObject
 {
     Q_OBJECT
 
+public:
+    // access kinds of data watchpoints, a change is a write of a new value; only memories can
+    // tell, writes to other devices always count as changes
+    static constexpr uint8_t WatchRead = 1 << 0;
+    static constexpr uint8_t WatchWrite = 1 << 1;
+    static constexpr uint8_t WatchChange = 1 << 2;
+
 public:
     explicit Debugger(Board* board);
     ~Debugger() override;
@@ -36,27 +48,64 @@ public:
 
     bool breakpointMatches(int address) const;
 
+    // both off by default, only to be used from the board thread
+    Coverage& coverage() { return coverage_; }
+    Profiler& profiler() { return profiler_; }
+
+    // a view follows the executed instructions
+    bool isObserved() const { return observers_.hasObservers(); }
+
+    // checked by the board on every bus access not served directly from memory, pages holding a
+    // watched address are kept off the direct paths; without watchpoints that is one branch
+    bool hasWatchpoints() const { return hasWatchpoints_; }
+    uint8_t watchFlags(uint16_t address) const { return watchFlags_[address]; }
+    // oldValue only for writes to memories
+    void handleWatchedAccess(uint16_t address, bool write, uint8_t value, std::optional<uint8_t> oldValue);
+
     void handleClockEdge(StateEdge edge);
+    // used when whole instructions are executed without driving the busses
+    void handleInstructionStart(int32_t address, uint8_t opcode);
+
+    // breakpoints do not stop the board while it replays history
+    void setReplaying(bool replaying) { replaying_ = replaying; }
+
+    void saveState(QDataStream& stream) const;
+    void restoreState(QDataStream& stream);
 
 signals:
     void newInstructionStart();
     void failStateChanged();
+    // the clock stops at the start of the instruction following the access
+    void watchpointHit(quint16 address, bool write, quint8 value);
 
 public slots:
     void stepInstruction();
     void stepSubroutine();
+    // both need the board history
+    void reverseStepInstruction();
+    void reverseContinue();
 
     void addBreakpoint(qint32 address);
     void removeBreakpoint(qint32 address);
 
+    // replaces the flags of a watchpoint on the same range
+    void addWatchpoint(qint32 start, qint32 end, quint8 flags);
+    void removeWatchpoint(qint32 start, qint32 end);
+
+protected:
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
+
 private:
     void reset();
-    void updateInstructionState(int32_t address);
+    void updateInstructionState(int32_t address, uint8_t opcode);
     void updateCallStack();
+    bool canTravel() const;
     void stopAtBreakpoint(int32_t address);
+    void stopAtWatchpoint();
+    void rebuildWatchFlags();
     void stopAfterInstruction();
     void stopAfterSubroutine();
-    void handleNewInstructionStart();
     void enterFailState();
 
 private:
@@ -67,8 +116,16 @@ private:
         Subroutine,
     };
 
+    struct Watchpoint
+    {
+        int32_t start;
+        int32_t end;
+        uint8_t flags;
+    };
+
 private:
     Board* board_;
+    ObserverRegistry observers_;
     uint8_t brkOpcode_{};
     uint8_t jsrOpcode_{};
     uint8_t rtsOpcode_{};
@@ -77,10 +134,23 @@ private:
     int32_t lastInstructionStart_{};
     uint8_t currentInstruction_{};
     int32_t currentInstructionStart_{};
+    uint64_t lastInstructionCycle_{};
+    uint64_t currentInstructionCycle_{};
     SteppingMode steppingMode_{SteppingMode::None};
     QSet<int32_t> breakpoints_;
     QVector<int32_t> callStack_;
     int steppingSubroutineCallStackStart_{};
+    bool replaying_{false};
+    // breakpoint hits before this cycle are collected while replaying for reverseContinue()
+    uint64_t breakpointSearchEnd_{};
+    std::optional<uint64_t> lastBreakpointHit_;
+    QVector<Watchpoint> watchpoints_;
+    // the flags of all watchpoints per address
+    QVector<uint8_t> watchFlags_;
+    bool hasWatchpoints_{false};
+    bool watchpointHitPending_{false};
+    Coverage coverage_;
+    Profiler profiler_;
 
     Q_DISABLE_COPY_MOVE(Debugger)
 };
@@ -21,8 +21,10 @@ Device::Device(const QString& name, Board* board) :
     QObject{nullptr},
     board_{board},
     mapAddressStart_{std::numeric_limits<uint16_t>::max()},
-    chipWasSelected_{},
-    chipSelected_{}
+    chipSelected_{},
+    nextEdge_{},
+    wakeEdge_{},
+    sleeping_{}
 {
     setObjectName(name);
 }
@@ -47,6 +49,22 @@ void Device::addBusConnection(const QString& portTagName, uint64_t portMask, Bus
     busConnections_.append(BusConnection{portTag, portMask, bus, busMask});
 }
 
+void Device::invalidateBusConnections()
+{
+    for (auto& bc : busConnections_)
+        bc.invalidate();
+}
+
+uint64_t Device::nextEventCycle() const
+{
+    return board_->cycleCount();
+}
+
+void Device::wakeOnBoard()
+{
+    board_->wakeDevice(this);
+}
+
 //void Device::setName(const QString& name)
 //{
 //    if (name == name_)
@@ -57,17 +75,12 @@ void Device::addBusConnection(const QString& portTagName, uint64_t portMask, Bus
 //    emit nameChanged();
 //}
 
-void Device::clockEdge(StateEdge edge)
+void Device::setSelected(bool selected)
 {
-    // TODO move chip selecting to board
-    chipWasSelected_ = chipSelected_;
-
-    auto address = board()->addressBus()->typedData<uint16_t>();
-
-    chipSelected_ = (address >= mapAddressStart()) && (address <= mapAddressEnd());
+    if (selected == chipSelected_)
+        return;
 
-    if (chipSelected_ != chipWasSelected_)
-        emit selectedChanged();
+    chipSelected_ = selected;
 
-    deviceClockEdge(edge);
+    emit selectedChanged();
 }
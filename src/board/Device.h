@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "Instrumentation.h"
 #include "WireState.h"
 #include <QObject>
 #include <QUuid>
@@ -21,6 +22,7 @@
 class Board;
 class Bus;
 class BusConnection;
+class QDataStream;
 
 class Device : public QObject
 {
@@ -42,8 +44,34 @@ public:
     void addBusConnection(const QString& portTagName, uint64_t portMask, Bus* bus, uint64_t busMask);
 
     bool isSelected() const { return chipSelected_; };
+    void setSelected(bool selected);
 
-    void clockEdge(StateEdge edge);
+    // devices that only act while selected are driven through the board's decode table,
+    // all others get every clock edge
+    virtual bool needsClockTick() const { return true; }
+
+    void clockEdge(StateEdge edge) { deviceClockEdge(edge); }
+
+    // ticking devices are put to sleep by the board until the cycle returned here, unless the
+    // cpu selects them or one of their busses changes; the edges slept through are handed to
+    // catchUp() before the next one. Returning the current cycle keeps the device ticking
+    static constexpr uint64_t NoEvent = std::numeric_limits<uint64_t>::max();
+    virtual uint64_t nextEventCycle() const;
+
+    // schedules the device for the next edge, for state changes from outside the board
+    void wake()
+    {
+        if (sleeping_)
+            wakeOnBoard();
+    }
+
+    // input from outside the board as posted through Board::postInput(), the channels are
+    // defined by the device
+    virtual void applyInput(uint8_t channel, uint32_t value) {}
+
+    // chip state for board snapshots, memory contents are handled by the board
+    virtual void saveState(QDataStream& stream) const {}
+    virtual void restoreState(QDataStream& stream) {}
 
 signals:
     void selectedChanged();
@@ -53,14 +81,30 @@ protected:
     virtual QString mapPortTagName(uint64_t portTag) const { return {}; }
     virtual int32_t calcMapAddressEnd() const { return mapAddressStart_ - 1; }
     virtual void deviceClockEdge(StateEdge edge) {}
+    // advances the state over edges the device slept through with unchanged inputs
+    virtual void catchUp(uint64_t raisingEdges, uint64_t fallingEdges) {}
+    // makes the next injection take all inputs from the busses again
+    void invalidateBusConnections();
 
 protected:
     Board* board_;
     int32_t mapAddressStart_;
-    bool chipWasSelected_;
     bool chipSelected_;
     QVector<BusConnection> busConnections_;
 
+private:
+    void wakeOnBoard();
+
+private:
+    // scheduling state, owned by the board
+    uint64_t nextEdge_;
+    uint64_t wakeEdge_;
+    bool sleeping_;
+    // host time of all edges the board handed to the device
+    Instrumentation::Counter timing_;
+
+    friend class Board;
+
     Q_DISABLE_COPY_MOVE(Device)
 };
 
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "History.h"
+
+#include "Memory.h"
+
+void History::setEnabled(bool enabled)
+{
+    enabled_ = enabled;
+    clear();
+}
+
+void History::setCheckpointInterval(uint64_t cycles)
+{
+    checkpointInterval_ = qMax(cycles, uint64_t{1});
+}
+
+void History::setBudget(qint64 bytes)
+{
+    budget_ = bytes;
+    prune();
+}
+
+qint64 History::size() const
+{
+    qint64 result = 0;
+    for (const auto& checkpoint : checkpoints_)
+    {
+        result += checkpoint.snapshot.size() + checkpoint.writes.size() * qint64{sizeof(Write)};
+    }
+    return result;
+}
+
+void History::addCheckpoint(uint64_t cycle, BoardSnapshot snapshot)
+{
+    checkpoints_.append({cycle, std::move(snapshot), {}});
+    nextCheckpointCycle_ = cycle + checkpointInterval_;
+
+    prune();
+}
+
+std::optional<uint64_t> History::checkpointBefore(uint64_t cycle) const
+{
+    for (auto checkpoint = checkpoints_.crbegin(); checkpoint != checkpoints_.crend(); ++checkpoint)
+    {
+        if (checkpoint->cycle < cycle)
+            return checkpoint->cycle;
+    }
+    return std::nullopt;
+}
+
+const BoardSnapshot* History::rewind(uint64_t cycle, uint64_t& checkpointCycle)
+{
+    if (checkpoints_.isEmpty() || checkpoints_.first().cycle > cycle)
+        return nullptr;
+
+    while (!checkpoints_.isEmpty())
+    {
+        auto& checkpoint = checkpoints_.last();
+
+        // newest first, so every byte ends up with the value it had at the checkpoint
+        for (auto write = checkpoint.writes.crbegin(); write != checkpoint.writes.crend(); ++write)
+        {
+            write->memory->data()[write->offset] = write->value;
+        }
+        checkpoint.writes.clear();
+
+        if (checkpoint.cycle <= cycle)
+            break;
+
+        checkpoints_.removeLast();
+    }
+
+    checkpointCycle = checkpoints_.last().cycle;
+    nextCheckpointCycle_ = checkpointCycle + checkpointInterval_;
+
+    return &checkpoints_.last().snapshot;
+}
+
+void History::clear()
+{
+    checkpoints_.clear();
+    nextCheckpointCycle_ = 0;
+}
+
+void History::prune()
+{
+    // the newest checkpoint is always kept, writes are logged against it
+    while (checkpoints_.size() > 1 && size() > budget_)
+    {
+        checkpoints_.removeFirst();
+    }
+}
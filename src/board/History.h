@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "BoardSnapshot.h"
+#include <QList>
+#include <QVector>
+#include <optional>
+
+class Memory;
+
+// Execution history of a board for seeking backwards. Checkpoints hold the board state
+// without memory contents; memory is rolled back by undoing the writes logged after each
+// checkpoint. The oldest checkpoints are dropped once the history exceeds its budget.
+class History
+{
+public:
+    static constexpr uint64_t DefaultCheckpointInterval = 1000000;
+    static constexpr qint64 DefaultBudget = 256 * 1024 * 1024;
+
+public:
+    bool isEnabled() const { return enabled_; }
+    void setEnabled(bool enabled);
+
+    uint64_t checkpointInterval() const { return checkpointInterval_; }
+    void setCheckpointInterval(uint64_t cycles);
+
+    // bytes used by checkpoints and logged writes
+    qint64 budget() const { return budget_; }
+    void setBudget(qint64 bytes);
+    qint64 size() const;
+
+    int checkpointCount() const { return checkpoints_.size(); }
+    uint64_t checkpointCycle(int index) const { return checkpoints_.at(index).cycle; }
+    // the newest checkpoint older than cycle; replays add and prune checkpoints, so walking the
+    // history backwards looks them up by cycle rather than by index
+    std::optional<uint64_t> checkpointBefore(uint64_t cycle) const;
+
+    bool isRecording() const { return enabled_ && !checkpoints_.isEmpty(); }
+    void recordWrite(Memory* memory, int32_t offset, uint8_t oldValue)
+    {
+        checkpoints_.last().writes.append({memory, offset, oldValue});
+    }
+
+    bool needsCheckpoint(uint64_t cycle) const { return enabled_ && cycle >= nextCheckpointCycle_; }
+    void addCheckpoint(uint64_t cycle, BoardSnapshot snapshot);
+
+    // undoes all writes back to the newest checkpoint not after cycle and drops every newer
+    // checkpoint; returns null when cycle is older than the history
+    const BoardSnapshot* rewind(uint64_t cycle, uint64_t& checkpointCycle);
+
+    void clear();
+
+private:
+    struct Write
+    {
+        Memory* memory;
+        int32_t offset;
+        uint8_t value;
+    };
+
+    struct Checkpoint
+    {
+        uint64_t cycle;
+        BoardSnapshot snapshot;
+        // writes after this checkpoint with the value they overwrote
+        QVector<Write> writes;
+    };
+
+private:
+    void prune();
+
+private:
+    bool enabled_{false};
+    uint64_t checkpointInterval_{DefaultCheckpointInterval};
+    qint64 budget_{DefaultBudget};
+    uint64_t nextCheckpointCycle_{0};
+    QList<Checkpoint> checkpoints_;
+};
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "InputLog.h"
+
+#include <QDebug>
+
+namespace {
+
+constexpr char FileMagic[] = {'6', '5', 'I', 'N'};
+constexpr uint8_t FileVersion = 1;
+
+void appendVarint(QByteArray& data, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        data.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data.append(static_cast<char>(value));
+}
+
+bool readVarint(const QByteArray& data, int& pos, uint64_t& value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 64 && pos < data.size(); shift += 7)
+    {
+        const auto byte = static_cast<uint8_t>(data.at(pos++));
+        value |= uint64_t{byte & 0x7Fu} << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void InputLog::startRecording(uint64_t startCycle)
+{
+    recording_ = true;
+    recordStart_ = startCycle;
+    inputs_.clear();
+}
+
+void InputLog::stopRecording()
+{
+    recording_ = false;
+}
+
+void InputLog::startReplay(const QVector<Input>& inputs, uint64_t startCycle)
+{
+    replay_ = inputs;
+    replayIndex_ = 0;
+    replayStart_ = startCycle;
+    nextReplayCycle_ = replay_.isEmpty() ? NoInput : replayStart_ + replay_.first().cycle;
+}
+
+void InputLog::stopReplay()
+{
+    replay_.clear();
+    replayIndex_ = 0;
+    nextReplayCycle_ = NoInput;
+}
+
+InputLog::Input InputLog::takeReplayInput()
+{
+    Q_ASSERT(isReplaying());
+
+    const auto input = replay_.at(replayIndex_++);
+    nextReplayCycle_ = replayIndex_ < replay_.size() ? replayStart_ + replay_.at(replayIndex_).cycle : NoInput;
+    return input;
+}
+
+QByteArray InputLog::encode(const QVector<Input>& inputs)
+{
+    QByteArray data{FileMagic, int{sizeof(FileMagic)}};
+    data.append(static_cast<char>(FileVersion));
+
+    uint64_t cycle = 0;
+    for (const auto& input : inputs)
+    {
+        appendVarint(data, input.cycle - cycle);
+        appendVarint(data, static_cast<uint64_t>(input.device + 1));
+        appendVarint(data, input.channel);
+        appendVarint(data, input.value);
+        cycle = input.cycle;
+    }
+
+    return data;
+}
+
+bool InputLog::decode(const QByteArray& data, QVector<Input>& inputs)
+{
+    inputs.clear();
+
+    if (!data.startsWith(QByteArray{FileMagic, int{sizeof(FileMagic)}}) || data.size() <= int{sizeof(FileMagic)} ||
+        static_cast<uint8_t>(data.at(sizeof(FileMagic))) != FileVersion)
+    {
+        qWarning() << "Not an input log";
+        return false;
+    }
+
+    int pos = sizeof(FileMagic) + 1;
+    uint64_t cycle = 0;
+    while (pos < data.size())
+    {
+        uint64_t delta{};
+        uint64_t device{};
+        uint64_t channel{};
+        uint64_t value{};
+        if (!readVarint(data, pos, delta) || !readVarint(data, pos, device) || !readVarint(data, pos, channel) ||
+            !readVarint(data, pos, value))
+        {
+            qWarning() << "Input log is truncated";
+            inputs.clear();
+            return false;
+        }
+
+        cycle += delta;
+        inputs.append({cycle, static_cast<int32_t>(device) - 1, static_cast<uint8_t>(channel),
+                       static_cast<uint32_t>(value)});
+    }
+
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QVector>
+#include <limits>
+
+// External inputs of a board with the cycle they were applied in. Replaying a recorded log on
+// the same board started from the same state applies every input in the same cycle again, so
+// runs driven by user input can be repeated exactly.
+class InputLog
+{
+public:
+    struct Input
+    {
+        // cycles since the start of the recording
+        uint64_t cycle;
+        // index in the board's devices, -1 for the board itself
+        int32_t device;
+        uint8_t channel;
+        uint32_t value;
+    };
+
+    static constexpr uint64_t NoInput = std::numeric_limits<uint64_t>::max();
+
+public:
+    bool isRecording() const { return recording_; }
+    // drops all recorded inputs, cycles are counted from startCycle on
+    void startRecording(uint64_t startCycle);
+    void stopRecording();
+    void record(uint64_t cycle, int32_t device, uint8_t channel, uint32_t value)
+    {
+        inputs_.append({cycle - recordStart_, device, channel, value});
+    }
+    const QVector<Input>& inputs() const { return inputs_; }
+
+    bool isReplaying() const { return nextReplayCycle_ != NoInput; }
+    // the inputs are due startCycle plus their cycle on
+    void startReplay(const QVector<Input>& inputs, uint64_t startCycle);
+    void stopReplay();
+    // board cycle of the next input to replay, NoInput when done
+    uint64_t nextReplayCycle() const { return nextReplayCycle_; }
+    Input takeReplayInput();
+
+    // variable length coded with cycle deltas, a few bytes per input
+    static QByteArray encode(const QVector<Input>& inputs);
+    static bool decode(const QByteArray& data, QVector<Input>& inputs);
+
+private:
+    bool recording_{false};
+    uint64_t recordStart_{};
+    QVector<Input> inputs_{};
+    QVector<Input> replay_{};
+    int replayIndex_{};
+    uint64_t replayStart_{};
+    uint64_t nextReplayCycle_{NoInput};
+};
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Instrumentation.h"
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+
+struct SignalSites
+{
+    QMutex mutex;
+    QVector<Instrumentation::SignalSite*> sites;
+};
+
+SignalSites& signalSites()
+{
+    static SignalSites sites;
+    return sites;
+}
+
+} // namespace
+
+void Instrumentation::Counter::reset()
+{
+    calls_.store(0, std::memory_order_relaxed);
+    ticks_.store(0, std::memory_order_relaxed);
+}
+
+Instrumentation::SignalSite::SignalSite(const char* signal, const char* file) :
+    signal{signal},
+    file{file}
+{
+    auto& sites = signalSites();
+    QMutexLocker locker{&sites.mutex};
+    sites.sites.append(this);
+}
+
+void Instrumentation::setEnabled(bool enabled)
+{
+    // calibrates the tick length before the first measurement
+    if (enabled)
+        hostTickNanoseconds();
+
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+Instrumentation::Entry Instrumentation::entry(const QString& name, const Counter& counter)
+{
+    return {name, counter.calls(), static_cast<double>(counter.ticks()) * hostTickNanoseconds()};
+}
+
+QVector<Instrumentation::Entry> Instrumentation::signalEntries()
+{
+    auto& sites = signalSites();
+    QMutexLocker locker{&sites.mutex};
+
+    QVector<Entry> entries;
+    for (const auto* site : qAsConst(sites.sites))
+    {
+        const auto name = QStringLiteral("%1 %2").arg(QFileInfo{QString::fromUtf8(site->file)}.completeBaseName(),
+                                                      QString::fromUtf8(site->signal));
+        entries.append(entry(name, site->counter));
+    }
+
+    return entries;
+}
+
+void Instrumentation::resetSignals()
+{
+    auto& sites = signalSites();
+    QMutexLocker locker{&sites.mutex};
+
+    for (auto* site : qAsConst(sites.sites))
+        site->counter.reset();
+}
+
+QJsonDocument Instrumentation::toJson(const QVector<Entry>& entries)
+{
+    QJsonArray list;
+    for (const auto& entry : entries)
+    {
+        QJsonObject object;
+        object[QStringLiteral("name")] = entry.name;
+        object[QStringLiteral("calls")] = static_cast<double>(entry.calls);
+        object[QStringLiteral("nanoseconds")] = entry.nanoseconds;
+        object[QStringLiteral("ns_per_call")] = entry.calls > 0 ? entry.nanoseconds / static_cast<double>(entry.calls) : 0.0;
+        list.append(object);
+    }
+
+    QJsonObject root;
+    root[QStringLiteral("tick_nanoseconds")] = hostTickNanoseconds();
+    root[QStringLiteral("sections")] = list;
+    return QJsonDocument{root};
+}
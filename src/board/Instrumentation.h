@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "utils/HostTimer.h"
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+class QJsonDocument;
+
+// Optional host time accounting of the emulation hot paths, to find the device or view that
+// slows a board down. Sections only read the tick counter while enabled, disabled they cost a
+// relaxed load and a branch. The switch is process wide, the counters belong to their owners.
+class Instrumentation
+{
+public:
+    class Counter
+    {
+    public:
+        void add(uint64_t startTicks)
+        {
+            const auto ticks = hostTicks() - startTicks;
+            calls_.fetch_add(1, std::memory_order_relaxed);
+            ticks_.fetch_add(ticks, std::memory_order_relaxed);
+        }
+
+        uint64_t calls() const { return calls_.load(std::memory_order_relaxed); }
+        uint64_t ticks() const { return ticks_.load(std::memory_order_relaxed); }
+        void reset();
+
+    private:
+        std::atomic<uint64_t> calls_{};
+        std::atomic<uint64_t> ticks_{};
+    };
+
+    // one EMIT_OBSERVED call site, registered for the lifetime of the process
+    class SignalSite
+    {
+    public:
+        SignalSite(const char* signal, const char* file);
+
+        Counter counter;
+        const char* signal;
+        const char* file;
+    };
+
+    struct Entry
+    {
+        QString name;
+        uint64_t calls;
+        double nanoseconds;
+    };
+
+public:
+    static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    static Entry entry(const QString& name, const Counter& counter);
+    // all signal sites emitted at least once while enabled
+    static QVector<Entry> signalEntries();
+    static void resetSignals();
+
+    static QJsonDocument toJson(const QVector<Entry>& entries);
+
+private:
+    static inline std::atomic_bool enabled_{false};
+};
+
+// accounts the enclosing scope to a counter while the instrumentation is enabled
+class ScopedTiming
+{
+public:
+    explicit ScopedTiming(Instrumentation::Counter& counter) :
+        counter_{Instrumentation::isEnabled() ? &counter : nullptr},
+        startTicks_{counter_ ? hostTicks() : 0}
+    {
+    }
+
+    ~ScopedTiming()
+    {
+        if (counter_)
+            counter_->add(startTicks_);
+    }
+
+private:
+    Instrumentation::Counter* counter_;
+    uint64_t startTicks_;
+
+    Q_DISABLE_COPY_MOVE(ScopedTiming)
+};
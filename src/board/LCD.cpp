@@ -18,6 +18,7 @@
 #include "BusConnection.h"
 #include "impl/hd44780u.h"
 #include "utils/ArrayView.h"
+#include <QDataStream>
 #include <QTimer>
 
 using PinMask = hd44780u::MPUPinMask;
@@ -38,6 +39,9 @@ LCD::LCD(const QString& name, Board* board) :
     Device{name, board},
     chip_{new hd44780u{}},
     pins_{},
+    busPins_{},
+    busPinsMask_{},
+    busExtractions_{},
     cursorPos_{},
     cursorOn_{true}
 {
@@ -97,20 +101,78 @@ void LCD::deviceClockEdge(StateEdge edge)
     populateState();
 }
 
+void LCD::catchUp(uint64_t raisingEdges, uint64_t fallingEdges)
+{
+    chip_->skipCycles(raisingEdges + fallingEdges);
+}
+
+uint64_t LCD::nextEventCycle() const
+{
+    // the chip only acts on enable edges, which come with a bus change, and counts down the
+    // busy time on every edge
+    if (!chip_->isBusy())
+        return NoEvent;
+
+    return board()->cycleCount() + chip_->busyCycles() / 2;
+}
+
+void LCD::saveState(QDataStream& stream) const
+{
+    chip_->saveState(stream);
+    stream << pins_ << cursorPos_ << cursorOn_;
+}
+
+void LCD::restoreState(QDataStream& stream)
+{
+    chip_->restoreState(stream);
+    stream >> pins_ >> cursorPos_ >> cursorOn_;
+    invalidateBusConnections();
+
+    for (uint8_t address = 0; address < bufferWidth() * 2; ++address)
+        emit characterChanged(address);
+    emit busyChanged();
+    emit cursorPosChanged();
+    emit cursorChanged();
+    emit displayShiftChanged();
+    emit displayChanged();
+}
+
 void LCD::injectState()
 {
+    // the pins are only extracted again after a bus changed
+    bool changed = false;
+    for (auto& bc : busConnections_)
+        changed = bc.takeChange() || changed;
+
+    if (!changed)
+    {
+        pins_ = static_cast<uint16_t>((pins_ & ~busPinsMask_) | busPins_);
+        return;
+    }
+
+    ++busExtractions_;
+    busPinsMask_ = 0;
+
     for (const auto& bc : qAsConst(busConnections_))
     {
-        const uint16_t busData = static_cast<uint16_t>(extractBits(bc.bus()->data(), bc.busMask()));
+        const uint16_t busData = static_cast<uint16_t>(BitMapping::extractBits(bc.bus()->data(), bc.busMask()));
+        PinMask mask{};
         if (bc.portTag() == Tags::DATA)
-            pins_ = hd44780u::inject(pins_, PinMask::Data, busData);
+            mask = PinMask::Data;
         else if (bc.portTag() == Tags::RS)
-            pins_ = hd44780u::inject(pins_, PinMask::RS, busData);
+            mask = PinMask::RS;
         else if (bc.portTag() == Tags::RW)
-            pins_ = hd44780u::inject(pins_, PinMask::RW, busData);
+            mask = PinMask::RW;
         else if (bc.portTag() == Tags::EN)
-            pins_ = hd44780u::inject(pins_, PinMask::EN, busData);
+            mask = PinMask::EN;
+        else
+            continue;
+
+        pins_ = hd44780u::inject(pins_, mask, busData);
+        busPinsMask_ |= static_cast<uint16_t>(mask);
     }
+
+    busPins_ = static_cast<uint16_t>(pins_ & busPinsMask_);
 }
 
 void LCD::populateState()
@@ -122,7 +184,7 @@ void LCD::populateState()
             if (bc.portTag() == Tags::DATA)
             {
                 const uint16_t pinData = hd44780u::extract(pins_, PinMask::Data);
-                const uint64_t busData = injectBits(uint16_t{}, static_cast<uint16_t>(bc.busMask()), pinData);
+                const uint64_t busData = BitMapping::depositBits(pinData, bc.busMask());
                 bc.bus()->setMaskedData(busData, bc.busMask());
                 break;
             }
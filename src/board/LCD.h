@@ -20,7 +20,7 @@ class Board;
 class Bus;
 class QTimer;
 
-class LCD : public Device, public hd44780u::listener
+class LCD final : public Device, public hd44780u::listener
 {
     Q_OBJECT
 
@@ -45,6 +45,11 @@ public:
     bool isDisplayOn() const;
     bool isCursorOn() const;
 
+    // times the pins were taken from the busses, unchanged busses reuse the last ones
+    uint64_t busExtractions() const { return busExtractions_; }
+
+    uint64_t nextEventCycle() const override;
+
 signals:
     void characterChanged(uint8_t address);
     void busyChanged();
@@ -58,6 +63,9 @@ protected:
     QString mapPortTagName(uint64_t portTag) const override;
     // update the hd44780u with the system clock to keep state when stepping
     void deviceClockEdge(StateEdge edge) override;
+    void catchUp(uint64_t raisingEdges, uint64_t fallingEdges) override;
+    void saveState(QDataStream& stream) const override;
+    void restoreState(QDataStream& stream) override;
 
 private:
     void setup();
@@ -67,8 +75,15 @@ private:
 private:
     QScopedPointer<hd44780u> chip_;
     uint16_t pins_;
+    // pins taken from the busses, reapplied while no bus changed
+    uint16_t busPins_;
+    uint16_t busPinsMask_;
+    uint64_t busExtractions_;
     uint16_t cursorPos_;
     bool cursorOn_;
 
+    // static dispatches tick the concrete type without virtual calls
+    friend class Board;
+
     Q_DISABLE_COPY_MOVE(LCD)
 };
@@ -16,9 +16,19 @@
 #include "utils/ArrayView.h"
 #include "Board.h"
 #include "Bus.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QMetaMethod>
 
 namespace {
 
+void countAccess(QVector<uint32_t>& counts, int32_t address)
+{
+    auto& count = counts[address];
+    if (count != std::numeric_limits<uint32_t>::max())
+        ++count;
+}
+
 } // namespace
 
 Memory::Memory(Type type, int32_t size, const QString& name, Board* board) :
@@ -26,7 +36,9 @@ Memory::Memory(Type type, int32_t size, const QString& name, Board* board) :
     type_{type},
     data_(size),
     lastAccessAddress_{0},
-    lastAccessWasWrite_{false}
+    lastAccessWasWrite_{false},
+    observers_{},
+    countingAccesses_{}
 {
     setup();
 }
@@ -45,6 +57,56 @@ void Memory::setData(int32_t index, const ArrayView& data)
     {
         data_[index + i] = data[i];
     }
+
+    board()->invalidateCode();
+}
+
+void Memory::startCountingAccesses()
+{
+    if (readCounts_.isEmpty())
+    {
+        readCounts_.fill(0, data_.size());
+        writeCounts_.fill(0, data_.size());
+        executeCounts_.fill(0, data_.size());
+    }
+
+    ++countingAccesses_;
+}
+
+void Memory::stopCountingAccesses()
+{
+    Q_ASSERT(countingAccesses_ > 0);
+    if (countingAccesses_ > 0)
+        --countingAccesses_;
+}
+
+void Memory::resetAccessCounts()
+{
+    readCounts_.fill(0);
+    writeCounts_.fill(0);
+    executeCounts_.fill(0);
+}
+
+bool Memory::restoreContents(const QVector<uint8_t>& contents)
+{
+    if (contents.size() != data_.size())
+    {
+        qWarning() << "Memory size does not match" << name();
+        return false;
+    }
+
+    data_ = contents;
+    return true;
+}
+
+void Memory::saveState(QDataStream& stream) const
+{
+    stream << lastAccessAddress_ << lastAccessWasWrite_;
+}
+
+void Memory::restoreState(QDataStream& stream)
+{
+    stream >> lastAccessAddress_ >> lastAccessWasWrite_;
 }
 
 int32_t Memory::calcMapAddressEnd() const
@@ -63,23 +125,45 @@ void Memory::deviceClockEdge(StateEdge edge)
 
         int32_t addr = brd->addressBus()->typedData<int32_t>() - mapAddressStart();
 
+        const uint32_t lines = brd->controlLines();
+        const bool read = lines & Board::RwLine;
+
         bool wasAccessed = false;
-        if (isHigh(brd->rwLine()))
+        if (read)
         {
             brd->dataBus()->setData(data_[addr]);
             wasAccessed = true;
+
+            if (countingAccesses_)
+                countAccess((lines & Board::SyncLine) ? executeCounts_ : readCounts_, addr);
         }
-        else if (isLow(brd->rwLine()) && isWriteable())
+        else if (isWriteable())
         {
+            brd->recordWrite(static_cast<uint16_t>(mapAddressStart() + addr), this, addr, data_[addr]);
             data_[addr] = brd->dataBus()->typedData<uint8_t>();
             wasAccessed = true;
+
+            if (countingAccesses_)
+                countAccess(writeCounts_, addr);
         }
 
         if (wasAccessed)
         {
             lastAccessAddress_ = addr;
-            lastAccessWasWrite_ = isLow(brd->rwLine());
-            emit accessed();
+            lastAccessWasWrite_ = !read;
+            EMIT_OBSERVED(observers_, accessed());
         }
     }
 }
+
+void Memory::connectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&Memory::accessed))
+        observers_.add();
+}
+
+void Memory::disconnectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&Memory::accessed))
+        observers_.remove();
+}
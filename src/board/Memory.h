@@ -14,11 +14,12 @@
 #pragma once
 
 #include "Device.h"
+#include "ObserverRegistry.h"
 #include <QVector>
 
 class ArrayView;
 
-class Memory : public Device
+class Memory final : public Device
 {
     Q_OBJECT
 
@@ -47,6 +48,30 @@ public:
 
     uint8_t byte(int32_t address) const { return data_[address]; }
 
+    // implicitly shared, used by board snapshots
+    QVector<uint8_t> contents() const { return data_; }
+    bool restoreContents(const QVector<uint8_t>& contents);
+
+    void saveState(QDataStream& stream) const override;
+    void restoreState(QDataStream& stream) override;
+
+    bool needsClockTick() const override { return false; }
+
+    // per byte access counts, saturating at their maximum and empty until counting was started
+    // once; opcode fetches count as executes only; counting goes on until every start was
+    // stopped again, all only from the board thread
+    bool isCountingAccesses() const { return countingAccesses_ > 0; }
+    void startCountingAccesses();
+    void stopCountingAccesses();
+    void resetAccessCounts();
+    const QVector<uint32_t>& readCounts() const { return readCounts_; }
+    const QVector<uint32_t>& writeCounts() const { return writeCounts_; }
+    const QVector<uint32_t>& executeCounts() const { return executeCounts_; }
+
+    // true while someone listens to accessed() or accesses are counted, the board then keeps
+    // accesses on the device path
+    bool isObserved() const { return observers_.hasObservers() || countingAccesses_ > 0; }
+
 signals:
     void accessed();
 
@@ -54,12 +79,19 @@ protected:
     void setup();
     int32_t calcMapAddressEnd() const override;
     void deviceClockEdge(StateEdge edge) override;
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
 
 private:
     Type type_;
     QVector<uint8_t> data_;
     int32_t lastAccessAddress_;
     bool lastAccessWasWrite_;
+    ObserverRegistry observers_;
+    int countingAccesses_;
+    QVector<uint32_t> readCounts_;
+    QVector<uint32_t> writeCounts_;
+    QVector<uint32_t> executeCounts_;
 
     Q_DISABLE_COPY_MOVE(Memory)
 };
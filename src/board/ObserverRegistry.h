@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Instrumentation.h"
+#include <QAtomicInt>
+
+// Counts the connections to the signals an object emits on the hot path. The owner feeds it
+// from connectNotify()/disconnectNotify() and skips emitting while nobody listens.
+class ObserverRegistry
+{
+public:
+#ifdef EMU_HEADLESS
+    constexpr bool hasObservers() const { return false; }
+#else
+    bool hasObservers() const { return observers_.loadRelaxed() > 0; }
+#endif
+
+    void add() { observers_.ref(); }
+    void remove() { observers_.deref(); }
+
+private:
+    QAtomicInt observers_{0};
+};
+
+// headless builds compile the emission out completely; with the instrumentation enabled every
+// call site accounts the time its receivers take
+#define EMIT_OBSERVED(registry, signal) \
+    do \
+    { \
+        if ((registry).hasObservers()) \
+        { \
+            if (Instrumentation::isEnabled()) \
+            { \
+                static Instrumentation::SignalSite observedSite{#signal, __FILE__}; \
+                const auto observedStartTicks = hostTicks(); \
+                emit signal; \
+                observedSite.counter.add(observedStartTicks); \
+            } \
+            else \
+            { \
+                emit signal; \
+            } \
+        } \
+    } while (false)
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Profiler.h"
+
+#include <QRegularExpression>
+
+namespace {
+
+constexpr int AddressCount = 0x10000;
+// deeper recursion without matching returns stays in its last context
+constexpr int MaxContexts = 0x10000;
+
+} // namespace
+
+uint64_t Profiler::Profile::totalCycles() const
+{
+    uint64_t total = 0;
+    for (const auto& context : contexts)
+        total += context.cycles;
+    return total;
+}
+
+QVector<Profiler::Subroutine> Profiler::Profile::subroutines() const
+{
+    // children always follow their parents
+    QVector<uint64_t> inclusive(contexts.size());
+    for (int i = contexts.size() - 1; i >= 0; --i)
+    {
+        inclusive[i] += contexts[i].cycles;
+        if (contexts[i].parent >= 0)
+            inclusive[contexts[i].parent] += inclusive[i];
+    }
+
+    struct Frame
+    {
+        int32_t context;
+        int child;
+    };
+
+    QVector<Subroutine> result;
+    QHash<int32_t, int> indices;
+    // entries on the current path, a recursive call is already part of the outer one
+    QHash<int32_t, int> active;
+    QVector<Frame> path;
+
+    const auto visit = [&](int32_t index) {
+        const auto& context = contexts[index];
+        if (context.entry != TopLevel)
+        {
+            auto pos = indices.find(context.entry);
+            if (pos == indices.end())
+            {
+                pos = indices.insert(context.entry, result.size());
+                result.append({context.entry, 0, 0, 0});
+            }
+
+            auto& subroutine = result[*pos];
+            subroutine.calls += context.calls;
+            subroutine.exclusiveCycles += context.cycles;
+            if (active.value(context.entry) == 0)
+                subroutine.inclusiveCycles += inclusive[index];
+        }
+
+        active[context.entry] += 1;
+        path.append({index, 0});
+    };
+
+    if (!contexts.isEmpty())
+        visit(0);
+
+    while (!path.isEmpty())
+    {
+        auto& frame = path.last();
+        const auto& children = contexts[frame.context].children;
+        if (frame.child < children.size())
+        {
+            visit(children[frame.child++]);
+        }
+        else
+        {
+            active[contexts[frame.context].entry] -= 1;
+            path.removeLast();
+        }
+    }
+
+    return result;
+}
+
+QVector<Profiler::Line> Profiler::Profile::lines(const QList<Program::SourceLine>& sourceLines) const
+{
+    QVector<Line> result;
+    if (addressExecutions.isEmpty())
+        return result;
+
+    for (int i = 0; i < sourceLines.size(); ++i)
+    {
+        const auto address = sourceLines[i].address;
+        if (address < 0 || address >= AddressCount || addressExecutions[address] == 0)
+            continue;
+
+        result.append({i, addressExecutions[address], addressCycles[address]});
+    }
+
+    return result;
+}
+
+QByteArray Profiler::Profile::foldedStacks(const QHash<int32_t, QString>& symbols) const
+{
+    QByteArray result;
+
+    // parents always come first
+    QVector<QByteArray> stacks(contexts.size());
+    for (int i = 0; i < contexts.size(); ++i)
+    {
+        const auto& context = contexts[i];
+
+        const auto frame = context.entry == TopLevel ? QStringLiteral("[top]") : symbolName(context.entry, symbols);
+
+        stacks[i] = context.parent >= 0 ? stacks[context.parent] + ';' + frame.toUtf8() : frame.toUtf8();
+
+        if (context.cycles > 0)
+            result += stacks[i] + ' ' + QByteArray::number(static_cast<qulonglong>(context.cycles)) + '\n';
+    }
+
+    return result;
+}
+
+Profiler::Profiler() :
+    enabled_{false},
+    context_{0},
+    hasPrevious_{false},
+    previousAddress_{},
+    previousCycle_{}
+{
+    clear();
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    enabled_ = enabled;
+
+    if (enabled_ && profile_.addressCycles.isEmpty())
+    {
+        profile_.addressCycles.fill(0, AddressCount);
+        profile_.addressExecutions.fill(0, AddressCount);
+    }
+
+    // the instructions in between were not seen
+    hasPrevious_ = false;
+}
+
+void Profiler::clear()
+{
+    profile_ = Profile{};
+    profile_.contexts.append({TopLevel, -1, 0, 0, {}});
+
+    if (enabled_)
+    {
+        profile_.addressCycles.fill(0, AddressCount);
+        profile_.addressExecutions.fill(0, AddressCount);
+    }
+
+    restart();
+}
+
+void Profiler::restart()
+{
+    context_ = 0;
+    hasPrevious_ = false;
+}
+
+QHash<int32_t, QString> Profiler::symbols(const QList<Program::SourceLine>& sourceLines)
+{
+    static const QRegularExpression labelExpression{QStringLiteral("^([A-Za-z_.][\\w.]*):")};
+
+    QHash<int32_t, QString> result;
+
+    QString label;
+    for (const auto& line : sourceLines)
+    {
+        const auto match = labelExpression.match(line.text);
+        if (match.hasMatch() && label.isEmpty())
+            label = match.captured(1);
+
+        if (line.address >= 0 && !label.isEmpty())
+        {
+            if (!result.contains(line.address))
+                result.insert(line.address, label);
+            label.clear();
+        }
+    }
+
+    return result;
+}
+
+QString Profiler::symbolName(int32_t address, const QHash<int32_t, QString>& symbols)
+{
+    const auto pos = symbols.find(address);
+    if (pos != symbols.end())
+        return *pos;
+
+    return QStringLiteral("$%1").arg(address, 4, 16, QLatin1Char('0'));
+}
+
+int32_t Profiler::enter(int32_t entry)
+{
+    for (const auto child : profile_.contexts[context_].children)
+    {
+        if (profile_.contexts[child].entry == entry)
+        {
+            profile_.contexts[child].calls += 1;
+            return child;
+        }
+    }
+
+    if (profile_.contexts.size() >= MaxContexts)
+        return context_;
+
+    const auto index = profile_.contexts.size();
+    profile_.contexts.append({entry, context_, 1, 0, {}});
+    profile_.contexts[context_].children.append(index);
+    return index;
+}
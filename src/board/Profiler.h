@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Program.h"
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+
+// Exact cycle profile of the guest code, fed by the Debugger with every instruction start. Each
+// instruction is charged the cycles up to the next start, per address and per calling context.
+// Contexts follow the jsr/rts pairs of the debugger's call stack, so an interrupt handler counts
+// for the routine it interrupted.
+class Profiler
+{
+public:
+    // entry of the context outside of any subroutine
+    static constexpr int32_t TopLevel = -1;
+
+    struct Context
+    {
+        int32_t entry;
+        int32_t parent; // index, -1 for the top level
+        uint64_t calls;
+        uint64_t cycles; // spent in the routine itself
+        QVector<int32_t> children;
+    };
+
+    struct Subroutine
+    {
+        int32_t entry;
+        uint64_t calls;
+        uint64_t inclusiveCycles; // recursive calls are counted once
+        uint64_t exclusiveCycles;
+    };
+
+    struct Line
+    {
+        int32_t index; // into Program::sourceLines()
+        uint64_t executions;
+        uint64_t cycles;
+    };
+
+    // copyable result, the first context is the top level
+    struct Profile
+    {
+        QVector<uint64_t> addressCycles;
+        QVector<uint64_t> addressExecutions;
+        QVector<Context> contexts;
+
+        uint64_t totalCycles() const;
+        QVector<Subroutine> subroutines() const;
+        // executed source lines
+        QVector<Line> lines(const QList<Program::SourceLine>& sourceLines) const;
+        // one "[top];caller;callee cycles" line per context, as read by flamegraph.pl or speedscope
+        QByteArray foldedStacks(const QHash<int32_t, QString>& symbols = {}) const;
+    };
+
+public:
+    Profiler();
+
+    // address tables are only allocated once enabled
+    bool isEnabled() const { return enabled_; }
+    void setEnabled(bool enabled);
+
+    const Profile& profile() const { return profile_; }
+    void clear();
+
+    // depthChange is 1 after a jsr and -1 after a rts, as seen by the debugger's call stack
+    void instructionStart(int32_t address, uint64_t cycle, int depthChange)
+    {
+        if (hasPrevious_)
+        {
+            const auto cycles = cycle - previousCycle_;
+            profile_.addressCycles[previousAddress_] += cycles;
+            profile_.addressExecutions[previousAddress_] += 1;
+            profile_.contexts[context_].cycles += cycles;
+        }
+
+        if (depthChange > 0)
+            context_ = enter(address);
+        else if (depthChange < 0 && profile_.contexts[context_].parent >= 0)
+            context_ = profile_.contexts[context_].parent;
+
+        hasPrevious_ = true;
+        previousAddress_ = static_cast<uint16_t>(address);
+        previousCycle_ = cycle;
+    }
+
+    // continues at the top level without charging the gap to the next instruction start, after
+    // resets and restored snapshots
+    void restart();
+
+    // maps code addresses to the labels in front of them
+    static QHash<int32_t, QString> symbols(const QList<Program::SourceLine>& sourceLines);
+    // the label of an address, else the address as $xxxx
+    static QString symbolName(int32_t address, const QHash<int32_t, QString>& symbols = {});
+
+private:
+    int32_t enter(int32_t entry);
+
+private:
+    Profile profile_;
+    bool enabled_;
+    int32_t context_;
+    bool hasPrevious_;
+    uint16_t previousAddress_;
+    uint64_t previousCycle_;
+};
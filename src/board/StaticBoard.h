@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Board.h"
+#include "Device.h"
+#include <QVector>
+#include <tuple>
+#include <utility>
+
+// chip select and ticking of a board's devices, replaces the decode table and the loop over
+// the ticking devices when set on a board
+class BoardDispatch
+{
+public:
+    virtual ~BoardDispatch() = default;
+
+    // takes the board's devices, false when they are not the ones the dispatch was built for
+    virtual bool bind(const QVector<Device*>& devices) = 0;
+    virtual Device* decode(uint16_t address) const = 0;
+    // ticks the awake devices in board order
+    virtual void tickDevices(Board* board, StateEdge edge, uint64_t edgeIndex) const = 0;
+};
+
+// one device of a static board, with the address range it is mapped to and whether it gets
+// every clock edge
+template<typename T, int32_t Start, int32_t End, bool Ticked>
+struct StaticDevice
+{
+    using Type = T;
+    static constexpr int32_t start = Start;
+    static constexpr int32_t end = End;
+    static constexpr bool ticked = Ticked;
+};
+
+// dispatch for a board whose devices are known at compile time, instantiated by the sources
+// 6502emu-boardgen writes; chip select compares against constants and the devices are ticked
+// through their concrete types
+template<typename... Devices>
+class StaticBoard final : public BoardDispatch
+{
+public:
+    bool bind(const QVector<Device*>& devices) override
+    {
+        devices_ = {};
+        if (devices.size() != static_cast<int>(sizeof...(Devices)))
+            return false;
+
+        return bindEach(devices, std::index_sequence_for<Devices...>{});
+    }
+
+    Device* decode(uint16_t address) const override
+    {
+        return decodeEach(address, std::index_sequence_for<Devices...>{});
+    }
+
+    void tickDevices(Board* board, StateEdge edge, uint64_t edgeIndex) const override
+    {
+        tickEach(board, edge, edgeIndex, std::index_sequence_for<Devices...>{});
+    }
+
+private:
+    template<size_t I>
+    using Entry = std::tuple_element_t<I, std::tuple<Devices...>>;
+
+    template<size_t... I>
+    bool bindEach(const QVector<Device*>& devices, std::index_sequence<I...>)
+    {
+        if ((bindDevice<I>(devices[static_cast<int>(I)]) && ...))
+            return true;
+
+        devices_ = {};
+        return false;
+    }
+
+    template<size_t I>
+    bool bindDevice(Device* device)
+    {
+        auto* typed = qobject_cast<typename Entry<I>::Type*>(device);
+        if (!typed || typed->mapAddressStart() != Entry<I>::start || typed->mapAddressEnd() != Entry<I>::end ||
+            typed->needsClockTick() != Entry<I>::ticked)
+        {
+            return false;
+        }
+
+        std::get<I>(devices_) = typed;
+        return true;
+    }
+
+    template<size_t I>
+    static constexpr bool selects(uint16_t address)
+    {
+        // one unsigned compare per device, empty ranges fold away
+        return Entry<I>::start <= Entry<I>::end &&
+               static_cast<uint32_t>(address - Entry<I>::start) <=
+                   static_cast<uint32_t>(Entry<I>::end - Entry<I>::start);
+    }
+
+    template<size_t... I>
+    Device* decodeEach(uint16_t address, std::index_sequence<I...>) const
+    {
+        // the first device wins on overlapping ranges, like in the decode table
+        Device* device = nullptr;
+        static_cast<void>(((selects<I>(address) && (device = std::get<I>(devices_), true)) || ...));
+        return device;
+    }
+
+    template<size_t... I>
+    void tickEach(Board* board, StateEdge edge, uint64_t edgeIndex, std::index_sequence<I...>) const
+    {
+        (tickDevice<I>(board, edge, edgeIndex), ...);
+    }
+
+    template<size_t I>
+    void tickDevice(Board* board, StateEdge edge, uint64_t edgeIndex) const
+    {
+        if constexpr (Entry<I>::ticked)
+            board->tickAwakeDevice(std::get<I>(devices_), edge, edgeIndex);
+    }
+
+private:
+    std::tuple<typename Devices::Type*...> devices_{};
+};
+
+// defined by the sources 6502emu-boardgen writes, only linked into binaries built for one board
+BoardDispatch* createStaticDispatch();
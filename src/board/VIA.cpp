@@ -17,7 +17,8 @@
 #include "Bus.h"
 #include "BusConnection.h"
 #include "impl/m6522.h"
-#include "utils/Bits.h"
+#include <QDataStream>
+#include <QMetaMethod>
 
 namespace {
 
@@ -27,6 +28,30 @@ enum Tags
     PB
 };
 
+// the chip state is streamed field by field, the layout of its structs depends on the compiler
+
+void savePort(QDataStream& stream, const m6522_port_t& port)
+{
+    stream << port.inpr << port.outr << port.ddr << port.pins << port.c1_in << port.c1_out << port.c1_triggered
+           << port.c2_in << port.c2_out << port.c2_triggered;
+}
+
+void restorePort(QDataStream& stream, m6522_port_t& port)
+{
+    stream >> port.inpr >> port.outr >> port.ddr >> port.pins >> port.c1_in >> port.c1_out >> port.c1_triggered
+           >> port.c2_in >> port.c2_out >> port.c2_triggered;
+}
+
+void saveTimer(QDataStream& stream, const m6522_timer_t& timer)
+{
+    stream << timer.latch << timer.counter << timer.t_bit << timer.t_out << timer.pip;
+}
+
+void restoreTimer(QDataStream& stream, m6522_timer_t& timer)
+{
+    stream >> timer.latch >> timer.counter >> timer.t_bit >> timer.t_out >> timer.pip;
+}
+
 } // namespace
 
 VIA::VIA(const QString& name, Board* board) :
@@ -37,7 +62,15 @@ VIA::VIA(const QString& name, Board* board) :
     previouseT2State_{},
     previouseIFRState_{},
     rsPinOffset_{},
-    useNmi_{}
+    useNmi_{},
+    injectedDirs_{},
+    paInputMask_{},
+    pbInputMask_{},
+    paInputs_{},
+    pbInputs_{},
+    busExtractions_{},
+    timerObservers_{},
+    ifrObservers_{}
 {
     m6522_init(chip_);
 }
@@ -69,7 +102,7 @@ QString VIA::mapPortTagName(uint64_t portTag) const
 
 void VIA::deviceClockEdge(StateEdge edge)
 {
-    if (isLow(board()->resetLine()))
+    if (!(board()->controlLines() & Board::ResetLine))
     {
         m6522_reset(chip_);
         pinState_ = 0;
@@ -88,6 +121,99 @@ void VIA::deviceClockEdge(StateEdge edge)
     }
 }
 
+void VIA::catchUp(uint64_t raisingEdges, uint64_t fallingEdges)
+{
+    const auto t1 = chip_->t1.counter;
+    const auto t2 = chip_->t2.counter;
+    const auto ifr = chip_->intr.ifr;
+
+    // unselected and with unchanged port inputs the chip only counts down its timers once the
+    // pipelines and edge detection settled, skip to the next underflow that matters
+    auto ticks = raisingEdges;
+    for (int settle = 0; ticks > 0 && (settle < 2 || !isTimerSettled()); ++settle, --ticks)
+        tickUnselected();
+
+    if (ticks > 0)
+    {
+        const auto skipped = qMin(ticks, quietTicks());
+        advanceTimers(skipped);
+        ticks -= skipped;
+    }
+
+    for (; ticks > 0; --ticks)
+        tickUnselected();
+
+    if (t1 != chip_->t1.counter)
+        EMIT_OBSERVED(timerObservers_, t1Changed());
+    if (t2 != chip_->t2.counter)
+        EMIT_OBSERVED(timerObservers_, t2Changed());
+    if (ifr != chip_->intr.ifr)
+        emit ifrChanged();
+}
+
+uint64_t VIA::nextEventCycle() const
+{
+    const auto cycle = board()->cycleCount();
+
+    // watched timers are shown every cycle
+    if (timerObservers_.hasObservers() || !isTimerSettled())
+        return cycle;
+
+    // wake the cycle before the next underflow that matters
+    const auto ticks = quietTicks();
+    return ticks == NoEvent ? NoEvent : cycle + ticks;
+}
+
+void VIA::saveState(QDataStream& stream) const
+{
+    savePort(stream, chip_->pa);
+    savePort(stream, chip_->pb);
+    saveTimer(stream, chip_->t1);
+    saveTimer(stream, chip_->t2);
+    stream << chip_->intr.ier << chip_->intr.ifr << chip_->intr.pip << chip_->acr << chip_->pcr
+           << static_cast<quint64>(chip_->pins);
+    stream << static_cast<quint64>(pinState_) << previouseT1State_ << previouseT2State_ << previouseIFRState_;
+}
+
+void VIA::restoreState(QDataStream& stream)
+{
+    quint64 chipPins{};
+    quint64 pinState{};
+    restorePort(stream, chip_->pa);
+    restorePort(stream, chip_->pb);
+    restoreTimer(stream, chip_->t1);
+    restoreTimer(stream, chip_->t2);
+    stream >> chip_->intr.ier >> chip_->intr.ifr >> chip_->intr.pip >> chip_->acr >> chip_->pcr >> chipPins;
+    chip_->pins = chipPins;
+    stream >> pinState >> previouseT1State_ >> previouseT2State_ >> previouseIFRState_;
+    pinState_ = pinState;
+    invalidateBusConnections();
+
+    emit paChanged();
+    emit pbChanged();
+    emit t1Changed();
+    emit t2Changed();
+    emit ifrChanged();
+    emit acrChanged();
+    emit pcrChanged();
+}
+
+void VIA::connectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&VIA::t1Changed) || signal == QMetaMethod::fromSignal(&VIA::t2Changed))
+        timerObservers_.add();
+    else if (signal == QMetaMethod::fromSignal(&VIA::ifrChanged))
+        ifrObservers_.add();
+}
+
+void VIA::disconnectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&VIA::t1Changed) || signal == QMetaMethod::fromSignal(&VIA::t2Changed))
+        timerObservers_.remove();
+    else if (signal == QMetaMethod::fromSignal(&VIA::ifrChanged))
+        ifrObservers_.remove();
+}
+
 uint8_t VIA::pa() const
 {
     return M6522_GET_PA(pinState_);
@@ -99,6 +225,7 @@ void VIA::setPa(uint8_t _pa)
         return;
 
     M6522_SET_PA(pinState_, _pa);
+    wake();
     emit paChanged();
 }
 
@@ -113,9 +240,18 @@ void VIA::setPb(uint8_t _pb)
         return;
 
     M6522_SET_PB(pinState_, _pb);
+    wake();
     emit pbChanged();
 }
 
+void VIA::applyInput(uint8_t channel, uint32_t value)
+{
+    if (channel == PaInput)
+        setPa(static_cast<uint8_t>(value));
+    else if (channel == PbInput)
+        setPb(static_cast<uint8_t>(value));
+}
+
 uint8_t VIA::paDir() const
 {
     return chip_->pa.ddr;
@@ -171,14 +307,6 @@ int32_t VIA::calcMapAddressEnd() const
     return mapAddressStart_ + 0xF;
 }
 
-void VIA::setPin(uint64_t pin, WireState state)
-{
-    if (isHigh(state))
-        pinState_ |= pin;
-    else if (isLow(state))
-        pinState_ &= ~pin;
-}
-
 uint8_t VIA::registerAddress()
 {
     uint16_t addr = board()->addressBus()->typedData<uint16_t>();
@@ -188,22 +316,20 @@ uint8_t VIA::registerAddress()
 
 void VIA::injectState()
 {
-    previouseT1State_ = chip_->t1.counter;
-    previouseT2State_ = chip_->t2.counter;
+    if (timerObservers_.hasObservers())
+    {
+        previouseT1State_ = chip_->t1.counter;
+        previouseT2State_ = chip_->t2.counter;
+    }
     previouseIFRState_ = chip_->intr.ifr;
 
     // unconditionally set all pins. Let the "chip" handle the rw,cs,rs flags
 
-    setPin(M6522_RW, board()->rwLine());
-
-    setPin(M6522_CS1, toState(isSelected()));
-    setPin(M6522_CS2, negate(toState(isSelected())));
-
-    uint8_t regAddr = registerAddress();
-    setPin(M6522_RS0, toState(regAddr & 0x1));
-    setPin(M6522_RS1, toState(regAddr & 0x2));
-    setPin(M6522_RS2, toState(regAddr & 0x4));
-    setPin(M6522_RS3, toState(regAddr & 0x8));
+    const uint32_t lines = board()->controlLines();
+    pinState_ = (pinState_ & ~(M6522_RW | M6522_CS1 | M6522_CS2 | M6522_RS_PINS)) |
+            ((lines & Board::RwLine) ? M6522_RW : 0) |
+            (isSelected() ? M6522_CS1 : M6522_CS2) |
+            (registerAddress() & M6522_RS_PINS);
 
     M6522_SET_DATA(pinState_, board()->dataBus()->typedData<uint8_t>());
 }
@@ -213,9 +339,9 @@ void VIA::populateState()
     if (pinState_ & M6522_IRQ)
     {
         if (useNmi_)
-            board()->setNmiLine(WireState::Low);
+            board()->setControlLines(0, Board::NmiLine);
         else
-            board()->setIrqLine(WireState::Low);
+            board()->setControlLines(0, Board::IrqLine);
     }
 
     if (isSelected())
@@ -233,9 +359,9 @@ void VIA::populateState()
                 emit pbChanged();
             else if (regNo == M6522_REG_T1CH || regNo == M6522_REG_T1CL ||
                      regNo == M6522_REG_T1LH || regNo == M6522_REG_T1LL)
-                emit t1Changed();
+                EMIT_OBSERVED(timerObservers_, t1Changed());
             else if (regNo == M6522_REG_T2CH || regNo == M6522_REG_T2CL)
-                emit t2Changed();
+                EMIT_OBSERVED(timerObservers_, t2Changed());
             else if (regNo == M6522_REG_IFR || regNo == M6522_REG_IER)
                 emit ifrChanged();
             else if (regNo == M6522_REG_ACR)
@@ -245,25 +371,141 @@ void VIA::populateState()
         }
     }
 
-    if (previouseT1State_ != chip_->t1.counter)
-        emit t1Changed();
+    // the timers change on almost every cycle, only compared while watched
+    if (timerObservers_.hasObservers())
+    {
+        if (previouseT1State_ != chip_->t1.counter)
+            emit t1Changed();
 
-    if (previouseT2State_ != chip_->t2.counter)
-        emit t2Changed();
+        if (previouseT2State_ != chip_->t2.counter)
+            emit t2Changed();
+    }
 
     if (previouseIFRState_ != chip_->intr.ifr)
         emit ifrChanged();
 }
 
+bool VIA::isTimerSettled() const
+{
+    // no interrupt on its way and both counters decrementing every tick
+    return !(pinState_ & M6522_IRQ) && !(chip_->intr.ifr & chip_->intr.ier) && !chip_->intr.pip &&
+            chip_->t1.pip == 0x0003 && chip_->t2.pip == 0x0003;
+}
+
+uint64_t VIA::quietTicks() const
+{
+    uint64_t ticks = NoEvent;
+
+    // underflows raising an interrupt, toggling PB7 or showing up in a watched IFR
+    if (((chip_->intr.ier & M6522_IRQ_T1) || M6522_ACR_T1_SET_PB7(chip_) || ifrObservers_.hasObservers()) &&
+        (M6522_ACR_T1_CONTINUOUS(chip_) || !chip_->t1.t_bit))
+        ticks = chip_->t1.counter;
+
+    // T2 only counts PB6 pulses in that mode, those come with a bus change
+    if (((chip_->intr.ier & M6522_IRQ_T2) || ifrObservers_.hasObservers()) && !M6522_ACR_T2_COUNT_PB6(chip_) &&
+        !chip_->t2.t_bit)
+        ticks = qMin(ticks, uint64_t{chip_->t2.counter});
+
+    return ticks;
+}
+
+void VIA::tickUnselected()
+{
+    pinState_ = m6522_tick(chip_, (pinState_ & ~M6522_CS1) | M6522_CS2);
+}
+
+void VIA::advanceTimers(uint64_t ticks)
+{
+    // T1 counts down to 0xFFFF and is reloaded from the latch one tick later
+    auto& t1 = chip_->t1;
+    const uint64_t counter1 = t1.counter;
+    if (ticks <= counter1)
+    {
+        t1.counter = static_cast<uint16_t>(counter1 - ticks);
+        t1.t_out = false;
+    }
+    else
+    {
+        const uint64_t sinceUnderflow = ticks - counter1 - 1;
+        const uint64_t period = uint64_t{t1.latch} + 2;
+        const uint64_t underflows = 1 + sinceUnderflow / period;
+        const uint64_t phase = sinceUnderflow % period;
+
+        t1.t_out = phase == 0;
+        if (t1.t_out)
+        {
+            t1.counter = 0xFFFF;
+            t1.pip |= 1 << M6522_PIP_TIMER_LOAD;
+        }
+        else
+        {
+            t1.counter = static_cast<uint16_t>(t1.latch - (phase - 1));
+        }
+
+        if (M6522_ACR_T1_CONTINUOUS(chip_))
+        {
+            if (underflows & 1)
+                t1.t_bit = !t1.t_bit;
+            chip_->intr.ifr |= M6522_IRQ_T1;
+        }
+        else if (!t1.t_bit)
+        {
+            chip_->intr.ifr |= M6522_IRQ_T1;
+            t1.t_bit = true;
+        }
+    }
+
+    // T2 wraps around without reload
+    auto& t2 = chip_->t2;
+    if (!M6522_ACR_T2_COUNT_PB6(chip_))
+    {
+        const uint64_t counter2 = t2.counter;
+        t2.counter = static_cast<uint16_t>(counter2 - ticks);
+        t2.t_out = t2.counter == 0xFFFF;
+        if (ticks > counter2 && !t2.t_bit)
+        {
+            chip_->intr.ifr |= M6522_IRQ_T2;
+            t2.t_bit = true;
+        }
+    }
+}
+
 void VIA::injectPBusses()
 {
+    // the inputs are only extracted again after a bus or the port directions changed
+    const uint16_t dirs = static_cast<uint16_t>(paDir() | pbDir() << 8);
+    bool changed = dirs != injectedDirs_;
+    for (auto& bc : busConnections_)
+        changed = bc.takeChange() || changed;
+
+    if (!changed)
+    {
+        setPa(static_cast<uint8_t>((pa() & ~paInputMask_) | paInputs_));
+        setPb(static_cast<uint8_t>((pb() & ~pbInputMask_) | pbInputs_));
+        return;
+    }
+
+    ++busExtractions_;
+    injectedDirs_ = dirs;
+    paInputMask_ = 0;
+    pbInputMask_ = 0;
+
     for (const auto& bc : qAsConst(busConnections_))
     {
         if (bc.portTag() == Tags::PA)
+        {
             setPa(injectPBusImpl(bc, pa(), paDir()));
+            paInputMask_ |= static_cast<uint8_t>(bc.portMask() & ~uint64_t{paDir()});
+        }
         else if (bc.portTag() == Tags::PB)
+        {
             setPb(injectPBusImpl(bc, pb(), pbDir()));
+            pbInputMask_ |= static_cast<uint8_t>(bc.portMask() & ~uint64_t{pbDir()});
+        }
     }
+
+    paInputs_ = static_cast<uint8_t>(pa() & paInputMask_);
+    pbInputs_ = static_cast<uint8_t>(pb() & pbInputMask_);
 }
 
 uint8_t VIA::injectPBusImpl(const BusConnection& bc, uint8_t pPins, uint8_t pDirs)
@@ -271,14 +513,9 @@ uint8_t VIA::injectPBusImpl(const BusConnection& bc, uint8_t pPins, uint8_t pDir
     const uint8_t inMask = static_cast<uint8_t>(bc.portMask()) & ~pDirs; // only use the bits from the mask that are inputs
     if (inMask == 0)
         return pPins;
-     // shift inMask right to get rid of trailing zeros
-    const uint8_t normInMask = extractBits(inMask, static_cast<uint8_t>(bc.portMask()));
-    // map inMask to the bus (shift left to fit the bus position)
-    const uint64_t busInMask = injectBits(uint64_t{}, bc.busMask(), uint64_t{normInMask});
-     // get data from bus
-    const uint64_t busValue = extractBits(bc.bus()->data(), busInMask);
     // fill bus data into port
-    return injectBits(pPins, inMask, static_cast<uint8_t>(busValue));
+    const uint8_t busValue = static_cast<uint8_t>(bc.busToPort(bc.bus()->data()));
+    return static_cast<uint8_t>((pPins & ~inMask) | (busValue & inMask));
 }
 
 void VIA::populatePBusses()
@@ -297,11 +534,6 @@ void VIA::populatePBusImpl(const BusConnection& bc, uint8_t pPins, uint8_t pDirs
     const uint8_t outMask = static_cast<uint8_t>(bc.portMask()) & pDirs; // only use the bits from the mask that are outputs
     if (outMask == 0)
         return;
-     // shift outMask right to get rid of trailing zeros
-    const uint8_t normOutMask = extractBits(outMask, static_cast<uint8_t>(bc.portMask()));
-    // map outMask to the bus (shift left to fit the bus position)
-    const uint64_t busOutMask = injectBits(uint64_t{}, bc.busMask(), uint64_t{normOutMask});
     // fill bus with pin data
-    uint8_t pinValue = extractBits(pPins, outMask);
-    bc.bus()->setData(injectBits(bc.bus()->data(), busOutMask, uint64_t{pinValue}));
+    bc.bus()->setMaskedData(bc.portToBus(pPins), bc.portToBus(outMask));
 }
@@ -14,6 +14,7 @@
 #pragma once
 
 #include "Device.h"
+#include "ObserverRegistry.h"
 
 extern "C" {
 struct _m6522_t;
@@ -22,10 +23,15 @@ typedef _m6522_t m6522_t;
 
 class Bus;
 
-class VIA : public Device
+class VIA final : public Device
 {
     Q_OBJECT
 
+public:
+    // input channels, setting the port pins
+    static constexpr uint8_t PaInput = 0;
+    static constexpr uint8_t PbInput = 1;
+
 public:
     VIA(const QString& name, Board* board);
     ~VIA() override;
@@ -51,6 +57,12 @@ public:
     uint8_t acr() const;
     uint8_t pcr() const;
 
+    // times the port inputs were taken from the busses, unchanged busses reuse the last ones
+    uint64_t busExtractions() const { return busExtractions_; }
+
+    uint64_t nextEventCycle() const override;
+    void applyInput(uint8_t channel, uint32_t value) override;
+
 signals:
     void paChanged();
     void pbChanged();
@@ -65,9 +77,13 @@ protected:
     QString mapPortTagName(uint64_t portTag) const override;
     int32_t calcMapAddressEnd() const override;
     void deviceClockEdge(StateEdge edge) override;
+    void catchUp(uint64_t raisingEdges, uint64_t fallingEdges) override;
+    void saveState(QDataStream& stream) const override;
+    void restoreState(QDataStream& stream) override;
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
 
 private:
-    void setPin(uint64_t pin, WireState state);
     uint8_t registerAddress();
     void injectState();
     void populateState();
@@ -75,6 +91,11 @@ private:
     uint8_t injectPBusImpl(const BusConnection& bc, uint8_t pPins, uint8_t pDirs);
     void populatePBusses();
     void populatePBusImpl(const BusConnection& bc, uint8_t pPins, uint8_t pDirs);
+    bool isTimerSettled() const;
+    // ticks until the next timer underflow that has to be run on the chip
+    uint64_t quietTicks() const;
+    void tickUnselected();
+    void advanceTimers(uint64_t ticks);
 
 private:
     m6522_t* chip_;
@@ -84,6 +105,18 @@ private:
     uint16_t previouseIFRState_;
     uint8_t rsPinOffset_;
     bool useNmi_;
+    // port inputs taken from the busses, reapplied while no bus changed
+    uint16_t injectedDirs_;
+    uint8_t paInputMask_;
+    uint8_t pbInputMask_;
+    uint8_t paInputs_;
+    uint8_t pbInputs_;
+    uint64_t busExtractions_;
+    ObserverRegistry timerObservers_;
+    ObserverRegistry ifrObservers_;
+
+    // static dispatches tick the concrete type without virtual calls
+    friend class Board;
 
     Q_DISABLE_COPY_MOVE(VIA)
 };
@@ -14,6 +14,7 @@
 #include "hd44780u.h"
 
 #include "utils/ArrayView.h"
+#include <QDataStream>
 #include <QTimer>
 
 #include "hd44780u_data.inl"
@@ -50,6 +51,29 @@ hd44780u::hd44780u() :
     cursorControl();
 }
 
+void hd44780u::saveState(QDataStream& stream) const
+{
+    stream << mpuPins_ << busyDelay_ << busy_;
+    stream.writeRawData(reinterpret_cast<const char*>(ddram_.data()), static_cast<int>(ddram_.size()));
+    stream.writeRawData(reinterpret_cast<const char*>(cgram_.data()), static_cast<int>(cgram_.size()));
+    stream << ramAddr_ << cursorPos_ << shift_ << ramSelector_ << increment_ << shiftEnabled_ << displayOn_
+           << cursorEnabled_ << cursorBlink_ << readDataValid_ << cursorOn_ << wasReadInstruction_;
+}
+
+void hd44780u::restoreState(QDataStream& stream)
+{
+    stream >> mpuPins_ >> busyDelay_ >> busy_;
+    stream.readRawData(reinterpret_cast<char*>(ddram_.data()), static_cast<int>(ddram_.size()));
+    stream.readRawData(reinterpret_cast<char*>(cgram_.data()), static_cast<int>(cgram_.size()));
+    stream >> ramAddr_ >> cursorPos_ >> shift_ >> ramSelector_ >> increment_ >> shiftEnabled_ >> displayOn_
+           >> cursorEnabled_ >> cursorBlink_ >> readDataValid_ >> cursorOn_ >> wasReadInstruction_;
+
+    if (cursorEnabled_ && cursorBlink_)
+        blinker_->start();
+    else
+        blinker_->stop();
+}
+
 void hd44780u::setListener(listener* listener)
 {
     listener_ = listener;
@@ -136,6 +160,22 @@ uint16_t hd44780u::cycle(uint16_t pins)
     return pins;
 }
 
+void hd44780u::skipCycles(uint64_t cycles)
+{
+    if (cycles == 0)
+        return;
+
+    wasReadInstruction_ = false;
+
+    // without enable edges only the busy time runs down
+    if (!busy_)
+        return;
+
+    busy_ = cycles < busy_ ? static_cast<uint16_t>(busy_ - cycles) : 0;
+    if (!busy_ && listener_)
+        listener_->onBusyChanged();
+}
+
 void hd44780u::onBlinkTick()
 {
     cursorOn_ = !cursorOn_;
@@ -20,6 +20,7 @@
 #include <limits>
 
 class ArrayView;
+class QDataStream;
 class QTimer;
 
 class hd44780u
@@ -67,6 +68,7 @@ public:
     uint8_t cursorPos() const;
     uint8_t displayShift() const { return shift_; }
     bool isBusy() const { return busy_ > 0; }
+    uint16_t busyCycles() const { return busy_; }
     bool isDisplayOn() const { return displayOn_; }
     bool isCursorOn() const { return cursorOn_; }
 
@@ -74,6 +76,10 @@ public:
     ArrayView charMatrix(uint8_t address) const;
 
     uint16_t cycle(uint16_t pins); // cycle is not necessarily a CPU cycle
+    void skipCycles(uint64_t cycles); // cycles with unchanged pins
+
+    void saveState(QDataStream& stream) const;
+    void restoreState(QDataStream& stream);
 
     bool wasReadInstruction() const { return wasReadInstruction_; }
 
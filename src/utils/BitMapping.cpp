@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BitMapping.h"
+
+#include "Bits.h"
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BIT_MAPPING_BMI2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+uint64_t extractBitsPortable(uint64_t value, uint64_t mask)
+{
+    uint64_t result{};
+    for (uint64_t bit = 1; mask != 0; bit <<= 1)
+    {
+        const uint64_t lowest = mask & -mask;
+        if (value & lowest)
+            result |= bit;
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+uint64_t depositBitsPortable(uint64_t value, uint64_t mask)
+{
+    uint64_t result{};
+    for (uint64_t bit = 1; mask != 0; bit <<= 1)
+    {
+        const uint64_t lowest = mask & -mask;
+        if (value & bit)
+            result |= lowest;
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+#ifdef BIT_MAPPING_BMI2
+__attribute__((target("bmi2"))) uint64_t extractBitsBmi2(uint64_t value, uint64_t mask)
+{
+    return _pext_u64(value, mask);
+}
+
+__attribute__((target("bmi2"))) uint64_t depositBitsBmi2(uint64_t value, uint64_t mask)
+{
+    return _pdep_u64(value, mask);
+}
+
+__attribute__((target("bmi2"))) uint64_t mapBitsBmi2(uint64_t value, uint64_t from, uint64_t to)
+{
+    return _pdep_u64(_pext_u64(value, from), to);
+}
+#endif
+
+// keeps the lowest count set bits of mask
+uint64_t lowestBits(uint64_t mask, uint8_t count)
+{
+    uint64_t result{};
+    for (; count > 0 && mask != 0; --count)
+    {
+        result |= mask & -mask;
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+} // namespace
+
+BitMapping::BitMapping(uint64_t from, uint64_t to) :
+    useBmi2_{hasBmi2()}
+{
+    const auto count = std::min(bitCount(from), bitCount(to));
+    from_ = lowestBits(from, count);
+    to_ = lowestBits(to, count);
+
+    for (uint32_t shift = 0; shift < 64; shift += 8)
+    {
+        const uint64_t laneMask = from_ & (uint64_t{0xff} << shift);
+        if (laneMask == 0)
+            continue;
+
+        // the bits of this byte land behind the ones of the lower bytes
+        const uint64_t lowerMask = from_ & ((uint64_t{1} << shift) - 1);
+        const uint64_t laneTo = lowestBits(to_, bitCount(lowerMask | laneMask)) &
+                                ~lowestBits(to_, bitCount(lowerMask));
+
+        Lane lane{shift, {}};
+        for (uint64_t value = 0; value < lane.table.size(); ++value)
+            lane.table[value] = depositBitsPortable(extractBitsPortable(value << shift, laneMask), laneTo);
+        lanes_.push_back(lane);
+    }
+}
+
+bool BitMapping::hasBmi2()
+{
+#ifdef BIT_MAPPING_BMI2
+    static const bool bmi2 = __builtin_cpu_supports("bmi2");
+    return bmi2;
+#else
+    return false;
+#endif
+}
+
+uint64_t BitMapping::mapBmi2(uint64_t value) const
+{
+#ifdef BIT_MAPPING_BMI2
+    return mapBitsBmi2(value, from_, to_);
+#else
+    return mapTables(value);
+#endif
+}
+
+uint64_t BitMapping::extractBits(uint64_t value, uint64_t mask)
+{
+#ifdef BIT_MAPPING_BMI2
+    if (hasBmi2())
+        return extractBitsBmi2(value, mask);
+#endif
+    return extractBitsPortable(value, mask);
+}
+
+uint64_t BitMapping::depositBits(uint64_t value, uint64_t mask)
+{
+#ifdef BIT_MAPPING_BMI2
+    if (hasBmi2())
+        return depositBitsBmi2(value, mask);
+#endif
+    return depositBitsPortable(value, mask);
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <vector>
+
+// moves the set bits of one mask onto the set bits of another one while keeping their order,
+// the n-th lowest bit of from ends up in the n-th lowest bit of to; masks don't need to be
+// contiguous, with differing bit counts only the lowest bits of the wider mask are used
+class BitMapping
+{
+public:
+    BitMapping() = default;
+    BitMapping(uint64_t from, uint64_t to);
+
+    uint64_t from() const { return from_; }
+    uint64_t to() const { return to_; }
+
+    // pdep(pext(value, from), to), a single instruction pair on cpus with BMI2
+    uint64_t map(uint64_t value) const
+    {
+        if (useBmi2_)
+            return mapBmi2(value);
+        return mapTables(value);
+    }
+
+    // the portable path through the precomputed per byte tables
+    uint64_t mapTables(uint64_t value) const
+    {
+        uint64_t result{};
+        for (const auto& lane : lanes_)
+            result |= lane.table[(value >> lane.shift) & 0xff];
+        return result;
+    }
+
+    static bool hasBmi2();
+    // packs the bits of value selected by mask into the low bits and the reverse
+    static uint64_t extractBits(uint64_t value, uint64_t mask);
+    static uint64_t depositBits(uint64_t value, uint64_t mask);
+
+private:
+    uint64_t mapBmi2(uint64_t value) const;
+
+private:
+    struct Lane
+    {
+        uint32_t shift;
+        std::array<uint64_t, 256> table;
+    };
+
+private:
+    uint64_t from_{};
+    uint64_t to_{};
+    bool useBmi2_{};
+    // one table for each byte of from with bits set in it
+    std::vector<Lane> lanes_{};
+};
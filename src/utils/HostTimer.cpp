@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HostTimer.h"
+
+#include <chrono>
+
+namespace {
+
+double calibrate()
+{
+#ifdef HOST_TIMER_TSC
+    // invariant tsc rates do not change, a short busy wait is precise enough
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto startTicks = hostTicks();
+    auto now = start;
+    while (now - start < std::chrono::milliseconds{10})
+        now = Clock::now();
+    const auto ticks = hostTicks() - startTicks;
+    const auto nanoseconds = std::chrono::duration<double, std::nano>(now - start).count();
+    return ticks > 0 ? nanoseconds / static_cast<double>(ticks) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+} // namespace
+
+double hostTickNanoseconds()
+{
+    static const double nanoseconds = calibrate();
+    return nanoseconds;
+}
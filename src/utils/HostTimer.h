@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HOST_TIMER_TSC
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// cheapest monotonic tick source of the host, the time stamp counter on x86; only differences
+// of two readings on one thread are meaningful
+inline uint64_t hostTicks()
+{
+#ifdef HOST_TIMER_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// length of one tick, measured against the steady clock on first use
+double hostTickNanoseconds();
@@ -15,6 +15,7 @@
 #include "ui_ACIAView.h"
 
 #include "LooseSignal.h"
+#include "board/Board.h"
 
 ACIAView::ACIAView(ACIA* acia, MainWindow* parent) :
     DeviceView{acia, parent},
@@ -77,7 +78,7 @@ void ACIAView::onDataEntered(const QByteArray& inputData)
 {
     for (const auto& byte : inputData)
     {
-        QMetaObject::invokeMethod(acia_, "receiveByte", Q_ARG(uint8_t, static_cast<uint8_t>(byte)));
+        acia_->board()->postInput(acia_, ACIA::SerialInput, static_cast<uint8_t>(byte));
     }
 }
 
@@ -20,24 +20,31 @@
 
 namespace {
 
-const QVector<int32_t> Periods{ // clazy:exclude=non-pod-global-static}
-    4000000,
-    2000000,
-    1000000,
-    500000,
-    200000,
-    100000,
-    10000,
-    1000,
-    100,
-    0,
+const QVector<double> Frequencies{ // clazy:exclude=non-pod-global-static}
+    0.25,
+    0.5,
+    1.0,
+    2.0,
+    5.0,
+    10.0,
+    100.0,
+    1000.0,
+    10000.0,
+    100000.0,
+    1000000.0,
+    4000000.0,
+    14000000.0,
+    0.0,
 };
 
-int findPeriodIndex(int32_t period)
+int findFrequencyIndex(double frequency)
 {
-    for (int i = 0; const auto& p : Periods)
+    if (frequency <= 0.0)
+        return Frequencies.size() - 1;
+
+    for (int i = 0; const auto& f : Frequencies)
     {
-        if (p <= period)
+        if (f >= frequency)
             return i;
         ++i;
     }
@@ -75,7 +82,7 @@ void ClockView::setClock(Clock* clock)
     LooseSignal::connect(clock_, &Clock::runningChanged, this, &ClockView::onClockRunningChanged);
     LooseSignal::connect(clock_, &Clock::clockCycleChanged, this, &ClockView::onClockCycleChanged);
 
-    ui->frequency->setCurrentIndex(findPeriodIndex(clock_->period()));
+    ui->frequency->setCurrentIndex(findFrequencyIndex(clock_->frequency()));
 
     onClockRunningChanged();
     onClockCycleChanged();
@@ -119,6 +126,6 @@ void ClockView::onFrequencyCurrentIndexChanged(int index)
     if (!clock_)
         return;
 
-    QMetaObject::invokeMethod(clock_, "setPeriod", Q_ARG(qint32, Periods[ui->frequency->currentIndex()]));
+    QMetaObject::invokeMethod(clock_, "setFrequency", Q_ARG(double, Frequencies[ui->frequency->currentIndex()]));
 }
 
@@ -13,8 +13,12 @@
 
 #include "MemoryPageView.h"
 
+#include "board/Debugger.h"
 #include "board/Memory.h"
+#include <QContextMenuEvent>
+#include <QMenu>
 #include <QPainter>
+#include <cmath>
 
 namespace {
 
@@ -29,7 +33,8 @@ MemoryPageView::MemoryPageView(QWidget* parent) :
     page_{},
     addressOffset_{},
     highLightByte_{0xFFFF},
-    highlightWrite_{false}
+    highlightWrite_{false},
+    heatmap_{Heatmap::None}
 {
     QFontMetrics metric{font_};
     charWidth_ = metric.horizontalAdvance(QLatin1Char('0'));
@@ -101,11 +106,87 @@ void MemoryPageView::resetHighlight()
     update();
 }
 
+void MemoryPageView::setHeatmap(Heatmap heatmap)
+{
+    if (heatmap == heatmap_)
+        return;
+
+    heatmap_ = heatmap;
+    update();
+}
+
+uint64_t MemoryPageView::accessCount(int32_t address) const
+{
+    const auto count = [address](const QVector<uint32_t>& counts) -> uint64_t {
+        return address < counts.size() ? counts[address] : 0;
+    };
+
+    switch (heatmap_)
+    {
+        case Heatmap::None:
+            break;
+        case Heatmap::Reads:
+            return count(memory_->readCounts());
+        case Heatmap::Writes:
+            return count(memory_->writeCounts());
+        case Heatmap::Executes:
+            return count(memory_->executeCounts());
+        case Heatmap::Accesses:
+            return count(memory_->readCounts()) + count(memory_->writeCounts()) + count(memory_->executeCounts());
+    }
+
+    return 0;
+}
+
+void MemoryPageView::contextMenuEvent(QContextMenuEvent* event)
+{
+    if (!memory_)
+        return;
+
+    const int dataViewOffset = HEADLINE_MARGIN + charHeight_;
+    const int x = event->pos().x() / (charWidth_ * 3);
+    const int y = (event->pos().y() - dataViewOffset) / charHeight_;
+    if (event->pos().y() < dataViewOffset || x >= 0x10 || y >= 0x10)
+        return;
+
+    const int32_t addr = page_ * 0x100 + y * 0x10 + x;
+    if (addr >= memory_->size())
+        return;
+
+    const auto flags = watchFlags_.value(addr);
+
+    QMenu menu{this};
+    menu.addSection(QStringLiteral("%1").arg(addressOffset_ + addr, 4, 16, QLatin1Char('0')));
+    const auto addAction = [&menu, flags](const QString& text, uint8_t flag) {
+        auto* action = menu.addAction(text);
+        action->setCheckable(true);
+        action->setChecked(flags & flag);
+        action->setData(flag);
+    };
+    addAction(tr("Watch reads"), Debugger::WatchRead);
+    addAction(tr("Watch writes"), Debugger::WatchWrite);
+    addAction(tr("Watch changes"), Debugger::WatchChange);
+
+    auto* action = menu.exec(event->globalPos());
+    if (!action)
+        return;
+
+    const auto newFlags = static_cast<uint8_t>(flags ^ action->data().toUInt());
+    if (newFlags != 0)
+        watchFlags_.insert(addr, newFlags);
+    else
+        watchFlags_.remove(addr);
+
+    update();
+    emit watchFlagsChanged(addr, newFlags);
+}
+
 void MemoryPageView::paintEvent(QPaintEvent* event)
 {
     static QBrush red{QColor{0xDD, 0x22, 0x22}};
     static QBrush green{QColor{0x22, 0xDD, 0x22}};
     static QBrush posBarBrush{QColor{0xCC, 0xCC, 0xCC}};
+    static QPen watchPen{QColor{0x22, 0x22, 0xDD}};
 
     QPainter p(this);
 
@@ -126,6 +207,17 @@ void MemoryPageView::paintEvent(QPaintEvent* event)
 
     p.fillRect(posBarPos, 0, posBarWidth, charHeight_, posBarBrush);
 
+    // logarithmic scale against the hottest byte of the whole memory, so pages compare
+    double heatScale = 0.0;
+    if (heatmap_ != Heatmap::None)
+    {
+        uint64_t maxCount = 0;
+        for (int32_t addr = 0; addr < memory_->size(); ++addr)
+            maxCount = qMax(maxCount, accessCount(addr));
+        if (maxCount > 0)
+            heatScale = 1.0 / std::log1p(static_cast<double>(maxCount));
+    }
+
     auto address = addressOffset_ + page_ * 0x100;
     p.drawText(0, charAscent_,
                QStringLiteral("Address: %2 - %3")
@@ -146,12 +238,30 @@ void MemoryPageView::paintEvent(QPaintEvent* event)
 
             int rowPos = y * charHeight_;
 
+            if (heatScale > 0.0)
+            {
+                const auto count = accessCount(addr);
+                if (count > 0)
+                {
+                    const auto heat = std::log1p(static_cast<double>(count)) * heatScale;
+                    p.fillRect(x * charWidth_ * 3, dataViewOffset + rowPos, charWidth_ * 2, charHeight_,
+                               QColor{0xFF, static_cast<int>(0xFF - heat * 0xB0), static_cast<int>(0xFF - heat * 0xFF)});
+                }
+            }
+
             if (byte == highLightByte_)
             {
                 p.fillRect(x * charWidth_ * 3, dataViewOffset + rowPos, charWidth_ * 2, charHeight_,
                            highlightWrite_ ? red : green);
             }
 
+            if (watchFlags_.contains(addr))
+            {
+                p.setPen(watchPen);
+                p.drawRect(x * charWidth_ * 3, dataViewOffset + rowPos, charWidth_ * 2 - 1, charHeight_ - 1);
+                p.setPen(Qt::black);
+            }
+
             p.drawText(x * charWidth_ * 3, dataViewOffset + rowPos + charAscent_,
                        QStringLiteral("%1").arg(memory_->byte(addr), 2, 16, QLatin1Char('0')));
         }
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <QHash>
 #include <QWidget>
 
 class Memory;
@@ -21,6 +22,17 @@ class MemoryPageView : public QWidget
 {
     Q_OBJECT
 
+public:
+    // access counts shown behind the bytes, see Memory::startCountingAccesses()
+    enum class Heatmap
+    {
+        None,
+        Reads,
+        Writes,
+        Executes,
+        Accesses,
+    };
+
 public:
     MemoryPageView(QWidget* parent = {});
     ~MemoryPageView() override;
@@ -40,10 +52,21 @@ public:
     void highlight(int32_t byte, bool write);
     void resetHighlight();
 
+    Heatmap heatmap() const { return heatmap_; }
+    void setHeatmap(Heatmap heatmap);
+
+    // Debugger watch flags per byte of the memory, framed and edited by the context menu
+    const QHash<int32_t, uint8_t>& watchFlags() const { return watchFlags_; }
+
 signals:
+    void watchFlagsChanged(int32_t byte, uint8_t flags);
 
 protected:
     void paintEvent(QPaintEvent* event) override;
+    void contextMenuEvent(QContextMenuEvent* event) override;
+
+private:
+    uint64_t accessCount(int32_t address) const;
 
 private:
     QFont font_;
@@ -55,6 +78,8 @@ private:
     int charAscent_;
     int32_t highLightByte_;
     bool highlightWrite_;
+    Heatmap heatmap_;
+    QHash<int32_t, uint8_t> watchFlags_;
 
     Q_DISABLE_COPY_MOVE(MemoryPageView)
 };
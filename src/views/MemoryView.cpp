@@ -22,11 +22,13 @@
 #include "ProgramFileWatcher.h"
 #include "board/Board.h"
 #include "board/Clock.h"
+#include "board/Debugger.h"
 #include "views/SourcesView.h"
 #include <QIntValidator>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QSettings>
+#include <QTimer>
 
 namespace {
 
@@ -34,6 +36,8 @@ const QString kSettingsLastAccesesdFilePath = QStringLiteral("LastAccesesdFilePa
 const QString kLoadedProgram = QStringLiteral("loaded_programm");
 const QString kAutoReload = QStringLiteral("auto_reload");
 
+constexpr int HeatmapUpdateInterval = 500;
+
 } // namespace
 
 MemoryView::MemoryView(Memory* memory, MainWindow* parent) :
@@ -43,7 +47,9 @@ MemoryView::MemoryView(Memory* memory, MainWindow* parent) :
     pageAutomaticallyChanged_{},
     sourcesView_{nullptr},
     fileSystemWatcher_(new ProgramFileWatcher(this)),
-    reloadInProgress_{false}
+    reloadInProgress_{false},
+    heatmapTimer_{new QTimer{this}},
+    countingAccesses_{false}
 {
     ui->setupUi(this);
     setup();
@@ -59,6 +65,17 @@ MemoryView::~MemoryView()
 
     mainWindow()->userState()->setViewValue(name(), kAutoReload, ui->autoReloadMode->currentIndex());
 
+    // counting keeps the memory off the fast paths, other views may still count
+    if (countingAccesses_)
+        QMetaObject::invokeMethod(memory_, [memory = memory_]() { memory->stopCountingAccesses(); });
+
+    const auto& watchFlags = ui->memoryPage->watchFlags();
+    for (auto it = watchFlags.begin(); it != watchFlags.end(); ++it)
+    {
+        const auto address = memory_->mapAddressStart() + it.key();
+        emit removeWatchpoint(address, address);
+    }
+
     if (sourcesView_)
         hideSources();
 
@@ -92,6 +109,16 @@ void MemoryView::setup()
     LooseSignal::connect(memory_, &Memory::selectedChanged, this, &MemoryView::onMemorySelectedChanged);
 
     connect(fileSystemWatcher_, &ProgramFileWatcher::programFileChanged, this, &MemoryView::onProgramFileChanged);
+
+    connect(ui->heatmap, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MemoryView::onHeatmapChanged);
+    connect(ui->resetCountsButton, &QPushButton::clicked, this, &MemoryView::onResetCountsButtonClicked);
+    connect(heatmapTimer_, &QTimer::timeout, this, [this]() { ui->memoryPage->update(); });
+
+    auto* debugger = mainWindow()->board()->debugger();
+    connect(ui->memoryPage, &MemoryPageView::watchFlagsChanged, this, &MemoryView::onWatchFlagsChanged);
+    connect(this, &MemoryView::addWatchpoint, debugger, &Debugger::addWatchpoint);
+    connect(this, &MemoryView::removeWatchpoint, debugger, &Debugger::removeWatchpoint);
+    connect(debugger, &Debugger::watchpointHit, this, &MemoryView::onWatchpointHit);
 }
 
 void MemoryView::maybeLoadProgram()
@@ -146,6 +173,64 @@ void MemoryView::onMemorySelectedChanged()
     }
 }
 
+void MemoryView::onHeatmapChanged(int index)
+{
+    const auto heatmap = static_cast<MemoryPageView::Heatmap>(index);
+    const bool counting = heatmap != MemoryPageView::Heatmap::None;
+
+    // the counters are allocated on the board thread; switching between heatmaps keeps counting
+    if (counting != countingAccesses_)
+    {
+        QMetaObject::invokeMethod(memory_, [memory = memory_, counting]() {
+            if (counting)
+                memory->startCountingAccesses();
+            else
+                memory->stopCountingAccesses();
+        }, Qt::BlockingQueuedConnection);
+        countingAccesses_ = counting;
+    }
+
+    ui->memoryPage->setHeatmap(heatmap);
+    ui->resetCountsButton->setEnabled(counting);
+
+    if (counting)
+        heatmapTimer_->start(HeatmapUpdateInterval);
+    else
+        heatmapTimer_->stop();
+}
+
+void MemoryView::onResetCountsButtonClicked()
+{
+    QMetaObject::invokeMethod(memory_, [memory = memory_]() {
+        memory->resetAccessCounts();
+    }, Qt::BlockingQueuedConnection);
+
+    ui->memoryPage->update();
+}
+
+void MemoryView::onWatchFlagsChanged(int32_t byte, uint8_t flags)
+{
+    const auto address = memory_->mapAddressStart() + byte;
+    if (flags != 0)
+        emit addWatchpoint(address, address, flags);
+    else
+        emit removeWatchpoint(address, address);
+}
+
+void MemoryView::onWatchpointHit(quint16 address, bool write)
+{
+    const auto byte = address - memory_->mapAddressStart();
+    if (byte < 0 || byte >= memory_->size() || !ui->memoryPage->watchFlags().contains(byte))
+        return;
+
+    const auto page = byte >> 8;
+    pageAutomaticallyChanged_ = true;
+    ui->memoryPage->setPage(page);
+    ui->page->setValue(page);
+    pageAutomaticallyChanged_ = false;
+    ui->memoryPage->highlight(byte & 0xFF, write);
+}
+
 void MemoryView::onSourcesViewClosingEvent()
 {
     auto* sourcesView = qobject_cast<SourcesView*>(sender());
@@ -233,6 +318,7 @@ void MemoryView::loadProgram(const QString& fileName)
     {
         memory_->data()[i] = static_cast<uint8_t>(program_.binaryData()[i]);
     }
+    memory_->board()->invalidateCode();
 
     ui->showSourcesButton->setEnabled(program_.hasSources());
     if (program_.hasSources() && sourcesView_)
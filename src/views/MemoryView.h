@@ -22,6 +22,7 @@ class MemoryView;
 }
 
 class ProgramFileWatcher;
+class QTimer;
 class SourcesView;
 
 class MemoryView : public DeviceView
@@ -34,6 +35,10 @@ public:
 
     void initialize() override;
 
+signals:
+    void addWatchpoint(qint32 start, qint32 end, quint8 flags);
+    void removeWatchpoint(qint32 start, qint32 end);
+
 private slots:
     void onMemoryAccessed();
     void onMemorySelectedChanged();
@@ -43,6 +48,10 @@ private slots:
     void onFollowButtonToggled(bool checked);
     void onPageValueChanged(int value);
     void onShowSourcesButtonClicked();
+    void onHeatmapChanged(int index);
+    void onResetCountsButtonClicked();
+    void onWatchFlagsChanged(int32_t byte, uint8_t flags);
+    void onWatchpointHit(quint16 address, bool write);
 
 private:
     void setup();
@@ -64,6 +73,9 @@ private:
     SourcesView* sourcesView_;
     ProgramFileWatcher* fileSystemWatcher_;
     bool reloadInProgress_;
+    QTimer* heatmapTimer_;
+    // this view holds one of the memory's access counting starts
+    bool countingAccesses_;
 
     Q_DISABLE_COPY_MOVE(MemoryView)
 };
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProfilerView.h"
+#include "ui_ProfilerView.h"
+
+#include "MainWindow.h"
+#include "ProgramLoader.h"
+#include "UserState.h"
+#include "board/Board.h"
+#include "board/Debugger.h"
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QTimer>
+
+namespace {
+
+constexpr int UpdateInterval = 1000;
+
+const QString kListing = QStringLiteral("listing");
+
+enum SubroutineColumn
+{
+    NameColumn,
+    CallsColumn,
+    InclusiveColumn,
+    ExclusiveColumn,
+    ShareColumn,
+};
+
+enum LineColumn
+{
+    AddressColumn,
+    LineNumberColumn,
+    SourceColumn,
+    ExecutionsColumn,
+    CyclesColumn,
+    LineShareColumn,
+};
+
+// sorts the number columns by value instead of text
+class ProfileItem : public QTreeWidgetItem
+{
+public:
+    using QTreeWidgetItem::QTreeWidgetItem;
+
+    bool operator<(const QTreeWidgetItem& other) const override
+    {
+        const int column = treeWidget() ? treeWidget()->sortColumn() : 0;
+        if (!data(column, Qt::UserRole).isValid())
+            return QTreeWidgetItem::operator<(other);
+
+        return data(column, Qt::UserRole).toDouble() < other.data(column, Qt::UserRole).toDouble();
+    }
+};
+
+void setNumber(QTreeWidgetItem* item, int column, double value, const QString& text)
+{
+    item->setText(column, text);
+    item->setData(column, Qt::UserRole, value);
+    item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+}
+
+void setCycles(QTreeWidgetItem* item, int column, uint64_t cycles)
+{
+    setNumber(item, column, static_cast<double>(cycles), QString::number(cycles));
+}
+
+void setShare(QTreeWidgetItem* item, int column, uint64_t cycles, uint64_t total)
+{
+    const auto share = total > 0 ? static_cast<double>(cycles) * 100.0 / static_cast<double>(total) : 0.0;
+    setNumber(item, column, share, QStringLiteral("%1%").arg(share, 0, 'f', 1));
+}
+
+void resizeItems(QTreeWidget* tree, int count)
+{
+    while (tree->topLevelItemCount() > count)
+        delete tree->takeTopLevelItem(tree->topLevelItemCount() - 1);
+    while (tree->topLevelItemCount() < count)
+        tree->addTopLevelItem(new ProfileItem{});
+}
+
+} // namespace
+
+ProfilerView::ProfilerView(const QString& name, MainWindow* mainWindow) :
+    View{name, mainWindow},
+    ui{new Ui::ProfilerView{}},
+    updateTimer_{new QTimer{this}}
+{
+    ui->setupUi(this);
+    setup();
+}
+
+ProfilerView::~ProfilerView()
+{
+    delete ui;
+}
+
+void ProfilerView::setup()
+{
+    ui->subroutines->sortByColumn(InclusiveColumn, Qt::DescendingOrder);
+    ui->lines->sortByColumn(CyclesColumn, Qt::DescendingOrder);
+
+    bool enabled = false;
+    withProfiler([&enabled](Profiler& profiler) { enabled = profiler.isEnabled(); });
+    ui->enabledCheckBox->setChecked(enabled);
+
+    const auto fileName = mainWindow()->userState()->viewValue(name(), kListing).toString();
+    if (!fileName.isEmpty())
+        loadListing(fileName);
+
+    connect(ui->enabledCheckBox, &QCheckBox::toggled, this, &ProfilerView::onEnabledToggled);
+    connect(ui->resetButton, &QToolButton::clicked, this, &ProfilerView::onResetClicked);
+    connect(ui->listingButton, &QToolButton::clicked, this, &ProfilerView::onListingClicked);
+    connect(ui->exportButton, &QToolButton::clicked, this, &ProfilerView::onExportClicked);
+    connect(updateTimer_, &QTimer::timeout, this, &ProfilerView::updateProfile);
+
+    updateTimer_->start(UpdateInterval);
+    updateProfile();
+}
+
+void ProfilerView::onEnabledToggled(bool enabled)
+{
+    withProfiler([enabled](Profiler& profiler) { profiler.setEnabled(enabled); });
+}
+
+void ProfilerView::onResetClicked()
+{
+    withProfiler([](Profiler& profiler) { profiler.clear(); });
+    updateProfile();
+}
+
+void ProfilerView::onListingClicked()
+{
+    const QString fileName = QFileDialog::getOpenFileName(this, tr("Open listing"), QString{},
+                                                          tr("Listing files (*.lst)"));
+    if (fileName.isEmpty())
+        return;
+
+    loadListing(fileName);
+    mainWindow()->userState()->setViewValue(name(), kListing, fileName);
+    updateProfile();
+}
+
+void ProfilerView::onExportClicked()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Export folded stacks"), QString{},
+                                                          tr("Folded stacks (*.folded *.txt)"));
+    if (fileName.isEmpty())
+        return;
+
+    Profiler::Profile profile;
+    withProfiler([&profile](Profiler& profiler) { profile = profiler.profile(); });
+
+    const auto stacks = profile.foldedStacks(symbols_);
+
+    QFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(stacks) != stacks.size())
+        QMessageBox::warning(this, tr("Export folded stacks"), tr("Could not write %1").arg(fileName));
+}
+
+void ProfilerView::loadListing(const QString& fileName)
+{
+    ProgramLoader loader;
+    program_ = loader.loadProgram(fileName);
+    symbols_ = Profiler::symbols(program_.sourceLines());
+}
+
+void ProfilerView::withProfiler(const std::function<void(Profiler& profiler)>& function) const
+{
+    auto* debugger = mainWindow()->board()->debugger();
+    QMetaObject::invokeMethod(debugger, [debugger, &function]() { function(debugger->profiler()); },
+                              Qt::BlockingQueuedConnection);
+}
+
+void ProfilerView::updateProfile()
+{
+    // a shallow copy, the board thread detaches on its next instruction
+    Profiler::Profile profile;
+    withProfiler([&profile](Profiler& profiler) { profile = profiler.profile(); });
+
+    updateSubroutines(profile);
+    updateLines(profile);
+}
+
+void ProfilerView::updateSubroutines(const Profiler::Profile& profile)
+{
+    const auto subroutines = profile.subroutines();
+    const auto total = profile.totalCycles();
+
+    ui->subroutines->setSortingEnabled(false);
+    resizeItems(ui->subroutines, subroutines.size());
+
+    for (int i = 0; i < subroutines.size(); ++i)
+    {
+        const auto& subroutine = subroutines[i];
+        auto* item = ui->subroutines->topLevelItem(i);
+
+        item->setText(NameColumn, Profiler::symbolName(subroutine.entry, symbols_));
+        setCycles(item, CallsColumn, subroutine.calls);
+        setCycles(item, InclusiveColumn, subroutine.inclusiveCycles);
+        setCycles(item, ExclusiveColumn, subroutine.exclusiveCycles);
+        setShare(item, ShareColumn, subroutine.inclusiveCycles, total);
+    }
+
+    ui->subroutines->setSortingEnabled(true);
+}
+
+void ProfilerView::updateLines(const Profiler::Profile& profile)
+{
+    const auto& sourceLines = program_.sourceLines();
+    const auto lines = profile.lines(sourceLines);
+    const auto total = profile.totalCycles();
+
+    ui->lines->setSortingEnabled(false);
+    resizeItems(ui->lines, lines.size());
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        const auto& line = lines[i];
+        const auto& sourceLine = sourceLines[line.index];
+        auto* item = ui->lines->topLevelItem(i);
+
+        setNumber(item, AddressColumn, sourceLine.address,
+                  QStringLiteral("%1").arg(sourceLine.address, 4, 16, QLatin1Char('0')));
+        setNumber(item, LineNumberColumn, sourceLine.line, QString::number(sourceLine.line));
+        item->setText(SourceColumn, sourceLine.text.trimmed());
+        setCycles(item, ExecutionsColumn, line.executions);
+        setCycles(item, CyclesColumn, line.cycles);
+        setShare(item, LineShareColumn, line.cycles, total);
+    }
+
+    ui->lines->setSortingEnabled(true);
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Program.h"
+#include "View.h"
+#include "board/Profiler.h"
+#include <functional>
+
+class QTimer;
+
+namespace Ui {
+class ProfilerView;
+}
+
+// cycles the guest code spends per subroutine and source line, see Profiler
+class ProfilerView : public View
+{
+    Q_OBJECT
+
+public:
+    ProfilerView(const QString& name, MainWindow* mainWindow);
+    ~ProfilerView() override;
+
+private slots:
+    void onEnabledToggled(bool enabled);
+    void onResetClicked();
+    void onListingClicked();
+    void onExportClicked();
+    void updateProfile();
+
+private:
+    void setup();
+    void loadListing(const QString& fileName);
+    // runs on the board thread and waits for it
+    void withProfiler(const std::function<void(Profiler& profiler)>& function) const;
+    void updateSubroutines(const Profiler::Profile& profile);
+    void updateLines(const Profiler::Profile& profile);
+
+private:
+    Ui::ProfilerView* ui;
+    QTimer* updateTimer_;
+    Program program_;
+    QHash<int32_t, QString> symbols_;
+
+    Q_DISABLE_COPY_MOVE(ProfilerView)
+};
@@ -60,5 +60,5 @@ void SignalsView::onBoardSignalChanged()
 
 void SignalsView::onResetButtonClicked()
 {
-    board_->setResetLine(WireState::Low);
+    board_->postInput(nullptr, Board::ResetInput, static_cast<uint32_t>(toInt(WireState::Low)));
 }
@@ -33,6 +33,8 @@ SourcesView::SourcesView(const QString& name, Program* program, MainWindow* main
 
 SourcesView::~SourcesView()
 {
+    // the board only steps whole instructions while nobody follows them
+    disconnect(mainWindow()->board()->debugger(), &Debugger::newInstructionStart, this, &SourcesView::onNewInstructionStart);
     delete ui;
 }
 
@@ -45,7 +47,6 @@ void SourcesView::setProgram(Program* program)
 void SourcesView::setup()
 {
     connect(mainWindow()->board()->clock(), &Clock::runningChanged, this, &SourcesView::onClockRunningChanged);
-    connect(mainWindow()->board()->debugger(), &Debugger::newInstructionStart, this, &SourcesView::onNewInstructionStart);
     connect(mainWindow()->board()->debugger(), &Debugger::failStateChanged, this, &SourcesView::onDebuggerFailStateChanged);
     connect(ui->stepInstructionButton, &QPushButton::clicked, mainWindow()->board()->debugger(), &Debugger::stepInstruction);
     connect(ui->stepSubroutineButton, &QPushButton::clicked, mainWindow()->board()->debugger(), &Debugger::stepSubroutine);
@@ -143,7 +144,14 @@ void SourcesView::setButtonStates()
 
 void SourcesView::onClockRunningChanged()
 {
-    clockRunning_ = mainWindow()->board()->clock()->isRunning();
+    auto board = mainWindow()->board();
+    clockRunning_ = board->clock()->isRunning();
+
+    // only follow instructions while stopped, like the disassembler
+    if (clockRunning_)
+        disconnect(board->debugger(), &Debugger::newInstructionStart, this, &SourcesView::onNewInstructionStart);
+    else
+        connect(board->debugger(), &Debugger::newInstructionStart, this, &SourcesView::onNewInstructionStart, Qt::UniqueConnection);
 
     onNewInstructionStart();
 }
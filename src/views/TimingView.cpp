@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TimingView.h"
+#include "ui_TimingView.h"
+
+#include "MainWindow.h"
+#include "board/Board.h"
+#include "board/Instrumentation.h"
+#include <QFile>
+#include <QFileDialog>
+#include <QJsonDocument>
+#include <QMessageBox>
+#include <QTimer>
+
+namespace {
+
+constexpr int UpdateInterval = 1000;
+
+enum Column
+{
+    NameColumn,
+    CallsColumn,
+    TimeColumn,
+    CallTimeColumn,
+    ShareColumn,
+};
+
+// sorts the number columns by value instead of text
+class SectionItem : public QTreeWidgetItem
+{
+public:
+    using QTreeWidgetItem::QTreeWidgetItem;
+
+    bool operator<(const QTreeWidgetItem& other) const override
+    {
+        const int column = treeWidget() ? treeWidget()->sortColumn() : NameColumn;
+        if (column == NameColumn)
+            return QTreeWidgetItem::operator<(other);
+
+        return data(column, Qt::UserRole).toDouble() < other.data(column, Qt::UserRole).toDouble();
+    }
+};
+
+void setNumber(QTreeWidgetItem* item, int column, double value, const QString& text)
+{
+    item->setText(column, text);
+    item->setData(column, Qt::UserRole, value);
+    item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+}
+
+} // namespace
+
+TimingView::TimingView(const QString& name, MainWindow* mainWindow) :
+    View{name, mainWindow},
+    ui{new Ui::TimingView{}},
+    updateTimer_{new QTimer{this}}
+{
+    ui->setupUi(this);
+    setup();
+}
+
+TimingView::~TimingView()
+{
+    delete ui;
+}
+
+void TimingView::setup()
+{
+    ui->sections->sortByColumn(TimeColumn, Qt::DescendingOrder);
+    ui->enabledCheckBox->setChecked(Instrumentation::isEnabled());
+
+    connect(ui->enabledCheckBox, &QCheckBox::toggled, this, &TimingView::onEnabledToggled);
+    connect(ui->resetButton, &QToolButton::clicked, this, &TimingView::onResetClicked);
+    connect(ui->saveButton, &QToolButton::clicked, this, &TimingView::onSaveClicked);
+    connect(updateTimer_, &QTimer::timeout, this, &TimingView::updateSections);
+
+    updateTimer_->start(UpdateInterval);
+    updateSections();
+}
+
+void TimingView::onEnabledToggled(bool enabled)
+{
+    Instrumentation::setEnabled(enabled);
+}
+
+void TimingView::onResetClicked()
+{
+    mainWindow()->board()->resetTimingStats();
+    updateSections();
+}
+
+void TimingView::onSaveClicked()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Save timing"), QString{},
+                                                          tr("JSON files (*.json)"));
+    if (fileName.isEmpty())
+        return;
+
+    const auto json = Instrumentation::toJson(mainWindow()->board()->timingStats()).toJson();
+
+    QFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+        QMessageBox::warning(this, tr("Save timing"), tr("Could not write %1").arg(fileName));
+}
+
+void TimingView::updateSections()
+{
+    const auto entries = mainWindow()->board()->timingStats();
+
+    // nested sections, like signals emitted by the cpu, are counted twice in the total
+    double total = 0.0;
+    for (const auto& entry : entries)
+        total += entry.nanoseconds;
+
+    ui->sections->setSortingEnabled(false);
+
+    while (ui->sections->topLevelItemCount() > entries.size())
+        delete ui->sections->takeTopLevelItem(ui->sections->topLevelItemCount() - 1);
+    while (ui->sections->topLevelItemCount() < entries.size())
+        ui->sections->addTopLevelItem(new SectionItem{});
+
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        const auto& entry = entries[i];
+        auto* item = ui->sections->topLevelItem(i);
+
+        const auto calls = static_cast<double>(entry.calls);
+        const auto callTime = entry.calls > 0 ? entry.nanoseconds / calls : 0.0;
+        const auto share = total > 0.0 ? entry.nanoseconds * 100.0 / total : 0.0;
+
+        item->setText(NameColumn, entry.name);
+        setNumber(item, CallsColumn, calls, QString::number(entry.calls));
+        setNumber(item, TimeColumn, entry.nanoseconds, QString::number(entry.nanoseconds / 1e6, 'f', 1));
+        setNumber(item, CallTimeColumn, callTime, QString::number(callTime, 'f', 1));
+        setNumber(item, ShareColumn, share, QStringLiteral("%1%").arg(share, 0, 'f', 1));
+    }
+
+    ui->sections->setSortingEnabled(true);
+}
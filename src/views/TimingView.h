@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "View.h"
+
+class QTimer;
+
+namespace Ui {
+class TimingView;
+}
+
+// host time the board spends per hot path section, see Instrumentation
+class TimingView : public View
+{
+    Q_OBJECT
+
+public:
+    TimingView(const QString& name, MainWindow* mainWindow);
+    ~TimingView() override;
+
+private slots:
+    void onEnabledToggled(bool enabled);
+    void onResetClicked();
+    void onSaveClicked();
+    void updateSections();
+
+private:
+    void setup();
+
+private:
+    Ui::TimingView* ui;
+    QTimer* updateTimer_;
+
+    Q_DISABLE_COPY_MOVE(TimingView)
+};
@@ -15,6 +15,7 @@
 #include "ui_VIAView.h"
 
 #include "LooseSignal.h"
+#include "board/Board.h"
 #include "impl/m6522.h"
 
 namespace {
@@ -148,10 +149,10 @@ void VIAView::onPCRChanged()
 
 void VIAView::onSetPa()
 {
-    via()->setPa(static_cast<uint8_t>(ui->paView->value()));
+    via()->board()->postInput(via(), VIA::PaInput, static_cast<uint32_t>(ui->paView->value()));
 }
 
 void VIAView::onSetPb()
 {
-    via()->setPb(static_cast<uint8_t>(ui->pbView->value()));
+    via()->board()->postInput(via(), VIA::PbInput, static_cast<uint32_t>(ui->pbView->value()));
 }
@@ -17,6 +17,8 @@
 #include "board/Device.h"
 #include "views/DeviceView.h"
 #include "views/DisassemblerView.h"
+#include "views/ProfilerView.h"
+#include "views/TimingView.h"
 
 class MainWindow;
 
@@ -108,3 +110,53 @@ private:
 
 using DisassemblerViewFactoryPointer = QSharedPointer<DisassemblerViewFactory>;
 Q_DECLARE_METATYPE(DisassemblerViewFactoryPointer)
+
+class TimingViewFactory : public ViewFactory
+{
+public:
+    static ViewFactoryPointer create(const QString& name)
+    {
+        return ViewFactoryPointer{new TimingViewFactory(name)};
+    }
+
+private:
+    TimingViewFactory(const QString& name) :
+        ViewFactory(name)
+    {
+    }
+
+    View* createViewImpl(MainWindow* mainWindow) override
+    {
+        auto* view = new TimingView(viewName_, mainWindow);
+        view->initialize();
+        return view;
+    }
+};
+
+using TimingViewFactoryPointer = QSharedPointer<TimingViewFactory>;
+Q_DECLARE_METATYPE(TimingViewFactoryPointer)
+
+class ProfilerViewFactory : public ViewFactory
+{
+public:
+    static ViewFactoryPointer create(const QString& name)
+    {
+        return ViewFactoryPointer{new ProfilerViewFactory(name)};
+    }
+
+private:
+    ProfilerViewFactory(const QString& name) :
+        ViewFactory(name)
+    {
+    }
+
+    View* createViewImpl(MainWindow* mainWindow) override
+    {
+        auto* view = new ProfilerView(viewName_, mainWindow);
+        view->initialize();
+        return view;
+    }
+};
+
+using ProfilerViewFactoryPointer = QSharedPointer<ProfilerViewFactory>;
+Q_DECLARE_METATYPE(ProfilerViewFactoryPointer)
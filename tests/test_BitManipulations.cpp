@@ -11,6 +11,7 @@
  * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "utils/BitMapping.h"
 #include "utils/Bits.h"
 
 #include <QtTest>
@@ -43,6 +44,35 @@ private slots:
 
         QCOMPARE(extractBits(value, mask), result);
     }
+
+    void bitMapping_data()
+    {
+        QTest::addColumn<quint64>("from");
+        QTest::addColumn<quint64>("to");
+        QTest::addColumn<quint64>("value");
+        QTest::addColumn<quint64>("result");
+
+        QTest::newRow("contiguous") << quint64{0x0f} << quint64{0xf0} << quint64{0x05} << quint64{0x50};
+        QTest::newRow("scattered") << quint64{0b10100101} << quint64{0x0f00} << quint64{0b10000100} << quint64{0x0a00};
+        QTest::newRow("interleave") << quint64{0xff} << quint64{0xaaaa} << quint64{0x0f} << quint64{0x00aa};
+        QTest::newRow("bytes") << quint64{0xff00ff} << quint64{0xffff} << quint64{0x120034} << quint64{0x1234};
+        QTest::newRow("high") << quint64{0xff00000000000000} << quint64{0x0f0f} << quint64{0xa5ffffffffffffff}
+                              << quint64{0x0a05};
+        QTest::newRow("truncated") << quint64{0xff} << quint64{0x0f00} << quint64{0xf3} << quint64{0x0300};
+    }
+
+    void bitMapping()
+    {
+        QFETCH(quint64, from);
+        QFETCH(quint64, to);
+        QFETCH(quint64, value);
+        QFETCH(quint64, result);
+
+        const BitMapping mapping{from, to};
+        QCOMPARE(mapping.map(value), result);
+        QCOMPARE(mapping.mapTables(value), result);
+        QCOMPARE(BitMapping::depositBits(BitMapping::extractBits(value, mapping.from()), mapping.to()), result);
+    }
 };
 
 #include "test_BitManipulations.moc"
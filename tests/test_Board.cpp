@@ -0,0 +1,1128 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "board/ACIA.h"
+#include "board/Board.h"
+#include "board/Bus.h"
+#include "board/CPU.h"
+#include "board/Debugger.h"
+#include "board/LCD.h"
+#include "board/Memory.h"
+#include "board/StaticBoard.h"
+#include "board/VIA.h"
+#include "LooseSignal.h"
+#include <QtTest>
+#include <random>
+
+class AccessListener : public QObject
+{
+public:
+    void onAccessed() {}
+};
+
+class TestBoard : public QObject
+{
+    Q_OBJECT
+
+private:
+    Board* board{};
+    Memory* ram{};
+    Memory* rom{};
+    VIA* via{};
+    ACIA* acia{};
+    LCD* lcd{};
+    Bus* portBus{};
+
+    enum IoDevices
+    {
+        NoIo = 0,
+        ViaIo = 1 << 0,   // VIA at 0x6000
+        AciaIo = 1 << 1,  // ACIA at 0x7000
+        LcdIo = 1 << 2,   // LCD, not mapped
+        PortBus = 1 << 3, // 16 bit bus, bits 0-7 on VIA port A and the LCD data, bit 8 on the LCD enable
+    };
+
+    // replaces the board by one with ram at 0x0000, rom at 0x8000 and the given io devices
+    void buildBoard(int ioDevices = NoIo)
+    {
+        cleanup();
+
+        board = new Board{};
+        QVector<Device*> devices;
+
+        via = nullptr;
+        if (ioDevices & ViaIo)
+        {
+            via = new VIA{QStringLiteral("VIA"), board};
+            via->setMapAddressStart(0x6000);
+            devices.append(via);
+        }
+
+        acia = nullptr;
+        if (ioDevices & AciaIo)
+        {
+            acia = new ACIA{QStringLiteral("ACIA"), board};
+            acia->setMapAddressStart(0x7000);
+            devices.append(acia);
+        }
+
+        lcd = nullptr;
+        if (ioDevices & LcdIo)
+        {
+            lcd = new LCD{QStringLiteral("LCD"), board};
+            devices.append(lcd);
+        }
+
+        ram = new Memory{Memory::Type::RAM, 0x8000, QStringLiteral("RAM"), board};
+        ram->setMapAddressStart(0x0000);
+        rom = new Memory{Memory::Type::ROM, 0x8000, QStringLiteral("ROM"), board};
+        rom->setMapAddressStart(0x8000);
+        devices << ram << rom;
+
+        QVector<Bus*> busses;
+        portBus = nullptr;
+        if (ioDevices & PortBus)
+        {
+            portBus = new Bus{QStringLiteral("PORT"), 16, board};
+            if (via)
+                via->addBusConnection(QStringLiteral("PA"), 0xFF, portBus, 0x00FF);
+            if (lcd)
+            {
+                lcd->addBusConnection(QStringLiteral("DATA"), 0xFF, portBus, 0x00FF);
+                lcd->addBusConnection(QStringLiteral("EN"), 0x01, portBus, 0x0100);
+            }
+            busses.append(portBus);
+        }
+
+        board->reset(devices, busses);
+    }
+
+    void loadRom(const QVector<uint8_t>& program)
+    {
+        for (int i = 0; i < program.size(); ++i)
+            rom->data()[i] = program[i];
+
+        // reset vector -> 0x8000
+        rom->data()[0x7FFC] = 0x00;
+        rom->data()[0x7FFD] = 0x80;
+    }
+
+    using StaticViaBoard = StaticBoard<StaticDevice<VIA, 0x6000, 0x600F, true>,
+                                       StaticDevice<Memory, 0x0000, 0x7FFF, false>,
+                                       StaticDevice<Memory, 0x8000, 0xFFFF, false>>;
+
+    // builds a board with a VIA and an irq handler at 0x8018 for the program
+    void buildViaBoard(const QVector<uint8_t>& program, bool watchTimers, bool staticDispatch = false)
+    {
+        buildBoard(ViaIo);
+        // watched timers keep the via ticking every cycle
+        if (watchTimers)
+            connect(via, &VIA::t1Changed, this, []() {});
+        if (staticDispatch)
+            board->setDispatch(new StaticViaBoard{});
+
+        loadRom(program);
+        rom->data()[0x7FFE] = 0x18;
+        rom->data()[0x7FFF] = 0x80;
+    }
+
+    QVector<uint8_t> runViaProgram(const QVector<uint8_t>& program, bool watchTimers, bool staticDispatch = false)
+    {
+        buildViaBoard(program, watchTimers, staticDispatch);
+        board->run(200000);
+        return ram->data();
+    }
+
+private slots:
+    void init()
+    {
+        buildBoard();
+    }
+
+    void cleanup()
+    {
+        delete board;
+        board = nullptr;
+    }
+
+    void find_device_decodes_ranges()
+    {
+        QCOMPARE(board->findDevice(0x0000), ram);
+        QCOMPARE(board->findDevice(0x7FFF), ram);
+        QCOMPARE(board->findDevice(0x8000), rom);
+        QCOMPARE(board->findDevice(0xFFFF), rom);
+        QCOMPARE(board->findDevice(0x10000), nullptr);
+        QCOMPARE(board->findDevice<Memory>(0x1234), ram);
+    }
+
+    void run_selects_addressed_device()
+    {
+        loadRom({
+            0x4C, 0x00, 0x80, // jmp $8000
+        });
+
+        board->run(10);
+        QVERIFY(rom->isSelected());
+        QVERIFY(!ram->isSelected());
+    }
+
+    void run_executes_cycles()
+    {
+        loadRom({
+            0xA9, 0x42,       // lda #$42
+            0x8D, 0x00, 0x02, // sta $0200
+            0x4C, 0x05, 0x80, // jmp $8005
+        });
+
+        QCOMPARE(board->run(100), uint64_t{100});
+        QCOMPARE(board->cycleCount(), uint64_t{100});
+        QCOMPARE(ram->byte(0x0200), uint8_t{0x42});
+    }
+
+    void run_observed_memory_uses_device_path()
+    {
+#ifdef EMU_HEADLESS
+        QSKIP("state change signals are compiled out");
+#endif
+        loadRom({
+            0xA9, 0x42,       // lda #$42
+            0x8D, 0x00, 0x02, // sta $0200
+            0x4C, 0x05, 0x80, // jmp $8005
+        });
+
+        int accesses = 0;
+        connect(ram, &Memory::accessed, this, [&accesses]() { ++accesses; });
+        QVERIFY(ram->isObserved());
+
+        board->run(100);
+        QCOMPARE(ram->byte(0x0200), uint8_t{0x42});
+        QVERIFY(accesses > 0);
+        QVERIFY(ram->lastAccessWasWrite());
+    }
+
+    void direct_access_resumes_after_observer_closed()
+    {
+#ifdef EMU_HEADLESS
+        QSKIP("state change signals are compiled out");
+#endif
+        QVERIFY(board->isDirect(0x0200));
+
+        auto* listener = new AccessListener;
+        LooseSignal::connect(ram, &Memory::accessed, listener, &AccessListener::onAccessed);
+        QVERIFY(!board->isDirect(0x0200));
+        QVERIFY(board->isDirect(0x8000));
+
+        delete listener;
+        QVERIFY(board->isDirect(0x0200));
+
+        auto* receiver = new QObject;
+        connect(ram, &Memory::accessed, receiver, []() {});
+        QVERIFY(!board->isDirect(0x0200));
+        delete receiver;
+        QVERIFY(board->isDirect(0x0200));
+    }
+
+    void timing_stats_account_sections()
+    {
+        loadRom({
+            0xA9, 0x42,       // lda #$42
+            0x8D, 0x00, 0x02, // sta $0200
+            0x4C, 0x05, 0x80, // jmp $8005
+        });
+
+        connect(ram, &Memory::accessed, this, []() {});
+
+        const auto calls = [this](const QString& name) {
+            for (const auto& entry : board->timingStats())
+            {
+                if (entry.name == name)
+                    return entry.calls;
+            }
+            return uint64_t{};
+        };
+
+        Instrumentation::setEnabled(true);
+        board->run(100);
+        Instrumentation::setEnabled(false);
+
+        QVERIFY(calls(QStringLiteral("CPU")) > 0);
+        QVERIFY(calls(QStringLiteral("RAM (Memory)")) > 0);
+#ifndef EMU_HEADLESS
+        QVERIFY(calls(QStringLiteral("Memory accessed()")) > 0);
+#endif
+
+        board->resetTimingStats();
+        board->run(100);
+        QCOMPARE(calls(QStringLiteral("CPU")), uint64_t{0});
+        QCOMPARE(calls(QStringLiteral("Memory accessed()")), uint64_t{0});
+    }
+
+    void memory_counts_accesses()
+    {
+        loadRom({
+            0xAD, 0x00, 0x02, // lda $0200
+            0x8D, 0x01, 0x02, // sta $0201
+            0x4C, 0x00, 0x80, // jmp $8000
+        });
+
+        ram->startCountingAccesses();
+        rom->startCountingAccesses();
+        board->setInstructionStepping(true);
+        QVERIFY(!board->isDirect(0x0200));
+
+        board->run(1000);
+
+        const auto loops = rom->executeCounts()[0x0006];
+        QVERIFY(loops > 0);
+        QVERIFY(rom->executeCounts()[0x0000] - loops <= 1);
+        QCOMPARE(rom->executeCounts()[0x0001], uint32_t{0});
+        QVERIFY(rom->readCounts()[0x0001] >= loops);
+        QVERIFY(ram->readCounts()[0x0200] >= loops);
+        QVERIFY(ram->writeCounts()[0x0201] >= loops);
+        QCOMPARE(ram->writeCounts()[0x0200], uint32_t{0});
+
+        ram->resetAccessCounts();
+        QCOMPARE(ram->readCounts()[0x0200], uint32_t{0});
+
+        // counted per user, as by two memory views
+        ram->startCountingAccesses();
+        ram->stopCountingAccesses();
+        QVERIFY(ram->isCountingAccesses());
+        QVERIFY(!board->isDirect(0x0200));
+
+        ram->stopCountingAccesses();
+        rom->stopCountingAccesses();
+        QVERIFY(!ram->isCountingAccesses());
+        QVERIFY(board->isDirect(0x0200));
+    }
+
+    void coverage_records_branches()
+    {
+        loadRom({
+            0xA2, 0x03,       // ldx #$03
+            0xCA,             // dex
+            0xD0, 0xFD,       // bne $8002
+            0x4C, 0x05, 0x80, // jmp $8005
+        });
+
+        auto& coverage = board->debugger()->coverage();
+        coverage.setEnabled(true);
+        board->run(200);
+
+        QVERIFY(coverage.isExecuted(0x8000));
+        QVERIFY(!coverage.isExecuted(0x8001));
+        QVERIFY(coverage.isExecuted(0x8005));
+        QVERIFY(coverage.isBranchTaken(0x8003));
+        QVERIFY(coverage.isBranchNotTaken(0x8003));
+        QVERIFY(!coverage.isBranchTaken(0x8005));
+
+        const QList<Program::SourceLine> sourceLines{
+            {1, -1, QLatin1Char(':'), QStringLiteral("reset:")},
+            {2, 0x8000, QLatin1Char(':'), QStringLiteral("    ldx #3")},
+            {3, -1, QLatin1Char(':'), QStringLiteral("loop:")},
+            {4, 0x8002, QLatin1Char(':'), QStringLiteral("    dex")},
+            {5, 0x8003, QLatin1Char(':'), QStringLiteral("    bne loop ; three times")},
+            {6, 0x8005, QLatin1Char(':'), QStringLiteral("end: jmp end")},
+            {7, 0x8008, QLatin1Char(':'), QStringLiteral("    nop")},
+            {8, 0x8009, QLatin1Char(':'), QStringLiteral("    byte $01")},
+        };
+
+        const auto summary = Coverage::summarize(coverage.lines(sourceLines));
+        QCOMPARE(summary.lines, 5);
+        QCOMPARE(summary.coveredLines, 4);
+        QCOMPARE(summary.branches, 2);
+        QCOMPARE(summary.coveredBranches, 2);
+
+        const auto lcov = coverage.toLcov(sourceLines, QStringLiteral("test.s"));
+        QVERIFY(lcov.startsWith("TN:\nSF:test.s\n"));
+        QVERIFY(lcov.contains("BRDA:5,0,0,1\n"));
+        QVERIFY(lcov.contains("DA:6,1\n"));
+        QVERIFY(lcov.contains("DA:7,0\n"));
+        QVERIFY(!lcov.contains("DA:8,"));
+        QVERIFY(lcov.contains("LH:4\n"));
+
+        QVERIFY(coverage.toCobertura(sourceLines, QStringLiteral("test.s")).contains("condition-coverage=\"100% (2/2)\""));
+
+        coverage.clear();
+        QVERIFY(!coverage.isExecuted(0x8000));
+    }
+
+    void watchpoints_stop_after_access()
+    {
+        loadRom({
+            0xA2, 0x00,       // ldx #$00
+            0xE8,             // inx
+            0x8E, 0x01, 0x02, // stx $0201
+            0xE0, 0x05,       // cpx #$05
+            0xD0, 0xF8,       // bne $8002
+            0xAD, 0x00, 0x02, // lda $0200
+            0x4C, 0x0D, 0x80, // jmp $800D
+        });
+
+        auto* debugger = board->debugger();
+        QSignalSpy hits{debugger, &Debugger::watchpointHit};
+        board->setInstructionStepping(true);
+
+        debugger->addWatchpoint(0x0201, 0x0201, Debugger::WatchChange);
+        QVERIFY(!board->isDirect(0x0200));
+
+        QVERIFY(board->run(1000) < 1000);
+        QCOMPARE(ram->byte(0x0201), uint8_t{1});
+        QCOMPARE(hits.size(), 1);
+        QCOMPARE(hits.last().at(0).toUInt(), 0x0201u);
+        QCOMPARE(hits.last().at(1).toBool(), true);
+        QCOMPARE(hits.last().at(2).toUInt(), 1u);
+
+        QVERIFY(board->run(1000) < 1000);
+        QCOMPARE(ram->byte(0x0201), uint8_t{2});
+
+        debugger->removeWatchpoint(0x0201, 0x0201);
+        debugger->addWatchpoint(0x0200, 0x0200, Debugger::WatchRead);
+        QVERIFY(board->run(1000) < 1000);
+        QCOMPARE(ram->byte(0x0201), uint8_t{5});
+        QCOMPARE(hits.last().at(0).toUInt(), 0x0200u);
+        QCOMPARE(hits.last().at(1).toBool(), false);
+
+        debugger->removeWatchpoint(0x0200, 0x0200);
+        QVERIFY(board->isDirect(0x0200));
+        QCOMPARE(board->run(1000), uint64_t{1000});
+    }
+
+    void profiler_accounts_subroutines()
+    {
+        QVector<uint8_t> program(0x22, 0xEA);
+        const QVector<uint8_t> main{
+            0x20, 0x10, 0x80, // jsr $8010
+            0x4C, 0x00, 0x80, // jmp $8000
+        };
+        const QVector<uint8_t> outer{
+            0xEE, 0x00, 0x04, // inc $0400
+            0x20, 0x20, 0x80, // jsr $8020
+            0x60,             // rts
+        };
+        std::copy(main.begin(), main.end(), program.begin());
+        std::copy(outer.begin(), outer.end(), program.begin() + 0x10);
+        program[0x21] = 0x60; // $8020: nop, rts
+        loadRom(program);
+
+        auto& profiler = board->debugger()->profiler();
+        profiler.setEnabled(true);
+        board->run(10000);
+
+        const auto& profile = profiler.profile();
+        uint64_t addressCycles = 0;
+        for (const auto cycles : profile.addressCycles)
+            addressCycles += cycles;
+        QCOMPARE(profile.totalCycles(), addressCycles);
+        QVERIFY(profile.addressExecutions[0x8021] > 0);
+
+        QHash<int32_t, Profiler::Subroutine> subroutines;
+        for (const auto& subroutine : profile.subroutines())
+            subroutines.insert(subroutine.entry, subroutine);
+        QCOMPARE(subroutines.size(), 2);
+
+        const auto outerRoutine = subroutines.value(0x8010);
+        const auto innerRoutine = subroutines.value(0x8020);
+        QVERIFY(innerRoutine.calls > 0);
+        QVERIFY(outerRoutine.calls - innerRoutine.calls <= 1);
+        QCOMPARE(innerRoutine.inclusiveCycles, innerRoutine.exclusiveCycles);
+        QVERIFY(outerRoutine.inclusiveCycles >= outerRoutine.exclusiveCycles + innerRoutine.inclusiveCycles);
+
+        QHash<int32_t, QString> symbols;
+        symbols.insert(0x8010, QStringLiteral("outer"));
+        QVERIFY(profile.foldedStacks(symbols).contains("[top];outer;$8020 "));
+
+        profiler.clear();
+        QCOMPARE(profiler.profile().totalCycles(), uint64_t{0});
+    }
+
+    void instruction_stepping_matches_cycles()
+    {
+        const QVector<uint8_t> program{
+            0xA2, 0x00,       // ldx #$00
+            0x8A,             // txa
+            0x9D, 0x00, 0x03, // sta $0300,x
+            0x20, 0x10, 0x80, // jsr $8010
+            0xE8,             // inx
+            0xE0, 0x20,       // cpx #$20
+            0xD0, 0xF4,       // bne $8002
+            0xF0, 0xFE,       // beq $800E
+            0xEE, 0x00, 0x04, // inc $0400
+            0x60,             // rts
+        };
+
+        loadRom(program);
+        QCOMPARE(board->run(2003), uint64_t{2003});
+        const auto pc = board->cpu()->registerPC();
+        const auto x = board->cpu()->registerX();
+        const auto ramData = ram->data();
+
+        cleanup();
+        init();
+
+        loadRom(program);
+        board->setInstructionStepping(true);
+        QCOMPARE(board->run(2003), uint64_t{2003});
+        QCOMPARE(board->cycleCount(), uint64_t{2003});
+        QCOMPARE(board->cpu()->registerPC(), pc);
+        QCOMPARE(board->cpu()->registerX(), x);
+        QCOMPARE(ram->data(), ramData);
+        QCOMPARE(ram->byte(0x0400), uint8_t{0x20});
+        QCOMPARE(ram->byte(0x031F), uint8_t{0x1F});
+    }
+
+    void instruction_stepping_takes_interrupts_in_time()
+    {
+        const QVector<uint8_t> program{
+            0xA9, 0x40,       // lda #$40
+            0x8D, 0x0B, 0x60, // sta $600B ; t1 free running
+            0xA9, 0x23,       // lda #$23
+            0x8D, 0x04, 0x60, // sta $6004
+            0xA9, 0x01,       // lda #$01
+            0x8D, 0x05, 0x60, // sta $6005
+            0xA9, 0xC0,       // lda #$C0
+            0x8D, 0x0E, 0x60, // sta $600E ; enable t1 interrupt
+            0x58,             // cli
+            0x4C, 0x30, 0x80, // jmp $8030
+            0xEE, 0x00, 0x02, // inc $0200 ; irq handler
+            0xAC, 0x00, 0x02, // ldy $0200
+            0x8A,             // txa
+            0x99, 0x00, 0x03, // sta $0300,y ; where the main loop was interrupted
+            0xAD, 0x04, 0x60, // lda $6004
+            0x40,             // rti
+            0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA,
+            0xE8,             // inx
+            0xEE, 0x01, 0x02, // inc $0201
+            0x4C, 0x30, 0x80, // jmp $8030
+        };
+
+        const auto ticked = runViaProgram(program, false);
+        const auto registers = [this]() {
+            const auto* cpu = board->cpu();
+            return QVector<uint64_t>{board->cycleCount(), cpu->registerPC(), cpu->registerA(),
+                                     cpu->registerX(), cpu->registerY(), cpu->registerS(), cpu->flags()};
+        };
+        const auto tickedRegisters = registers();
+        QVERIFY(ticked[0x0200] > 5);
+
+        for (const bool blockCaching : {true, false})
+        {
+            buildViaBoard(program, false);
+            board->setInstructionStepping(true);
+            board->setBlockCaching(blockCaching);
+            board->run(200000);
+            QCOMPARE(ram->data(), ticked);
+            QCOMPARE(registers(), tickedRegisters);
+        }
+    }
+
+    void instruction_stepping_leaves_jammed_core()
+    {
+        loadRom({
+            0xEA, // nop
+            0x02, // jam ; reads $FFFF in every cycle from here on
+        });
+
+        board->setInstructionStepping(true);
+        QCOMPARE(board->run(1000), uint64_t{1000});
+        QCOMPARE(board->cycleCount(), uint64_t{1000});
+        QCOMPARE(board->addressBus()->typedData<uint16_t>(), uint16_t{0xFFFF});
+
+        QCOMPARE(board->run(3), uint64_t{3});
+        QCOMPARE(board->run(1001), uint64_t{1001});
+        QCOMPARE(board->cycleCount(), uint64_t{2004});
+    }
+
+    void block_cache_matches_core_on_random_code()
+    {
+        // every documented opcode, so decimal mode, page crossings and jmp ($xxFF) come up as well
+        static constexpr uint8_t documented[] = {
+            0x69, 0x65, 0x75, 0x6D, 0x7D, 0x79, 0x61, 0x71, // adc
+            0x29, 0x25, 0x35, 0x2D, 0x3D, 0x39, 0x21, 0x31, // and
+            0x0A, 0x06, 0x16, 0x0E, 0x1E,                   // asl
+            0x90, 0xB0, 0xF0, 0x30, 0xD0, 0x10, 0x50, 0x70, // branches
+            0x24, 0x2C,                                     // bit
+            0x00, 0x40,                                     // brk, rti
+            0x18, 0xD8, 0x58, 0xB8, 0x38, 0xF8, 0x78,       // flags
+            0xC9, 0xC5, 0xD5, 0xCD, 0xDD, 0xD9, 0xC1, 0xD1, // cmp
+            0xE0, 0xE4, 0xEC, 0xC0, 0xC4, 0xCC,             // cpx, cpy
+            0xC6, 0xD6, 0xCE, 0xDE, 0xCA, 0x88,             // dec, dex, dey
+            0x49, 0x45, 0x55, 0x4D, 0x5D, 0x59, 0x41, 0x51, // eor
+            0xE6, 0xF6, 0xEE, 0xFE, 0xE8, 0xC8,             // inc, inx, iny
+            0x4C, 0x6C, 0x20, 0x60,                         // jmp, jsr, rts
+            0xA9, 0xA5, 0xB5, 0xAD, 0xBD, 0xB9, 0xA1, 0xB1, // lda
+            0xA2, 0xA6, 0xB6, 0xAE, 0xBE,                   // ldx
+            0xA0, 0xA4, 0xB4, 0xAC, 0xBC,                   // ldy
+            0x4A, 0x46, 0x56, 0x4E, 0x5E,                   // lsr
+            0xEA,                                           // nop
+            0x09, 0x05, 0x15, 0x0D, 0x1D, 0x19, 0x01, 0x11, // ora
+            0x48, 0x08, 0x68, 0x28,                         // stack
+            0x2A, 0x26, 0x36, 0x2E, 0x3E,                   // rol
+            0x6A, 0x66, 0x76, 0x6E, 0x7E,                   // ror
+            0xE9, 0xE5, 0xF5, 0xED, 0xFD, 0xF9, 0xE1, 0xF1, // sbc
+            0x85, 0x95, 0x8D, 0x9D, 0x99, 0x81, 0x91,       // sta
+            0x86, 0x96, 0x8E, 0x84, 0x94, 0x8C,             // stx, sty
+            0xAA, 0xA8, 0xBA, 0x8A, 0x9A, 0x98,             // transfers
+        };
+
+        std::mt19937 random{6502};
+        const auto randomByte = [&random]() { return static_cast<uint8_t>(random() & 0xFF); };
+
+        struct Machine
+        {
+            Board board;
+            Memory* ram;
+            Memory* rom;
+
+            explicit Machine(const QVector<uint8_t>& memory)
+            {
+                ram = new Memory{Memory::Type::RAM, 0x8000, QStringLiteral("RAM"), &board};
+                ram->setMapAddressStart(0x0000);
+                rom = new Memory{Memory::Type::ROM, 0x8000, QStringLiteral("ROM"), &board};
+                rom->setMapAddressStart(0x8000);
+                board.reset({ram, rom}, {});
+                ram->data() = memory.mid(0, 0x8000);
+                rom->data() = memory.mid(0x8000);
+            }
+
+            QVector<uint64_t> state() const
+            {
+                const auto* cpu = board.cpu();
+                return {board.cycleCount(), cpu->registerPC(), cpu->registerA(), cpu->registerX(),
+                        cpu->registerY(), cpu->registerS(), cpu->flags()};
+            }
+        };
+
+        for (int program = 0; program < 8; ++program)
+        {
+            // mostly opcodes, so operands and data are opcodes as well and the code runs into
+            // every kind of access; ram code is rewritten by the stores
+            QVector<uint8_t> memory(0x10000);
+            for (auto& byte : memory)
+                byte = random() % 20 ? documented[random() % sizeof(documented)] : randomByte();
+            for (int i = 0; i < 64; ++i)
+            {
+                const auto at = static_cast<int>(random() % 0xFFF0);
+                memory[at] = 0x6C;
+                memory[at + 1] = 0xFF;
+                memory[at + 2] = randomByte();
+            }
+
+            Machine cycled{memory};
+            Machine stepped{memory};
+            stepped.board.setInstructionStepping(true);
+            QVERIFY(stepped.board.isBlockCaching());
+
+            // compare in random slices, stepping never runs past the end of one
+            for (int slice = 0; slice < 200; ++slice)
+            {
+                const auto cycles = 16 + random() % 240;
+                QCOMPARE(stepped.board.run(cycles), cycled.board.run(cycles));
+                QCOMPARE(stepped.state(), cycled.state());
+                QCOMPARE(stepped.ram->data(), cycled.ram->data());
+            }
+        }
+    }
+
+    void block_cache_follows_self_modifying_code()
+    {
+        const QVector<uint8_t> code{
+            0xA9, 0x01,       // lda #$01
+            0x8D, 0x00, 0x04, // sta $0400
+            0xEE, 0x01, 0x02, // inc $0201
+            0x4C, 0x00, 0x02, // jmp $0200
+        };
+
+        const auto load = [this, &code]() {
+            loadRom({
+                0x4C, 0x00, 0x02, // jmp $0200
+            });
+            for (int i = 0; i < code.size(); ++i)
+                ram->data()[0x0200 + i] = code[i];
+        };
+
+        load();
+        QCOMPARE(board->run(2003), uint64_t{2003});
+        const auto a = board->cpu()->registerA();
+        const auto ramData = ram->data();
+
+        cleanup();
+        init();
+
+        load();
+        board->setInstructionStepping(true);
+        QVERIFY(board->isBlockCaching());
+        QCOMPARE(board->run(2003), uint64_t{2003});
+        QCOMPARE(board->cpu()->registerA(), a);
+        QCOMPARE(ram->data(), ramData);
+        QVERIFY(ram->byte(0x0201) > 0x10);
+    }
+
+    void control_line_changes_coalesced()
+    {
+#ifdef EMU_HEADLESS
+        QSKIP("state change signals are compiled out");
+#endif
+        // a nop sled toggles the sync line every cycle
+        rom->data().fill(0xEA);
+        loadRom({});
+
+        int changes = 0;
+        connect(board, &Board::signalChanged, this, [&changes]() { ++changes; });
+
+        board->setResetLine(WireState::Low);
+        QCOMPARE(changes, 1);
+        QVERIFY(!(board->controlLines() & Board::ResetLine));
+
+        changes = 0;
+        board->setResetLine(WireState::Low);
+        QCOMPARE(changes, 0);
+
+        board->setResetLine(WireState::High);
+        QCOMPARE(changes, 1);
+        QCOMPARE(board->resetLine(), WireState::High);
+        board->run(20);
+
+        // one notification per batch that ends with other lines than the one before
+        board->setRunSliceCycles(1);
+        changes = 0;
+        QCOMPARE(board->run(10), uint64_t{10});
+        QCOMPARE(changes, 10);
+
+        board->setRunSliceCycles(2);
+        changes = 0;
+        QCOMPARE(board->run(10), uint64_t{10});
+        QCOMPARE(changes, 0);
+
+        board->setRunSliceCycles(11);
+        changes = 0;
+        QCOMPARE(board->run(11), uint64_t{11});
+        QCOMPARE(changes, 1);
+    }
+
+    void via_extracts_inputs_after_bus_changes()
+    {
+        buildBoard(ViaIo | PortBus);
+        // watched timers keep the via ticking every cycle
+        connect(via, &VIA::t1Changed, this, []() {});
+        rom->data().fill(0xEA);
+        loadRom({});
+
+        portBus->setData(0x0042);
+        board->run(100);
+        QCOMPARE(via->pa(), uint8_t{0x42});
+
+        // unchanged busses reuse the inputs taken before
+        const auto extractions = via->busExtractions();
+        board->run(1000);
+        QCOMPARE(via->busExtractions(), extractions);
+        QCOMPARE(via->pa(), uint8_t{0x42});
+
+        portBus->setData(0x0024);
+        board->run(10);
+        QCOMPARE(via->busExtractions(), extractions + 1);
+        QCOMPARE(via->pa(), uint8_t{0x24});
+
+        board->run(1000);
+        QCOMPARE(via->busExtractions(), extractions + 1);
+        QCOMPARE(via->pa(), uint8_t{0x24});
+    }
+
+    void lcd_extracts_pins_after_bus_changes()
+    {
+        buildBoard(LcdIo | PortBus);
+        rom->data().fill(0xEA);
+        loadRom({});
+
+        // a clear display instruction; woken by a bus change the lcd ticks on both edges of the
+        // cycle, but takes the pins only once
+        portBus->setData(0x0101);
+        board->run(1);
+        const auto extractions = lcd->busExtractions();
+        portBus->setData(0x0001);
+        board->run(1);
+        QCOMPARE(lcd->busExtractions(), extractions + 1);
+        QVERIFY(lcd->isBusy());
+
+        // woken again when the busy time ran out, with the pins taken before
+        board->run(20);
+        QVERIFY(!lcd->isBusy());
+        QCOMPARE(lcd->busExtractions(), extractions + 1);
+
+        portBus->setData(0x0002);
+        board->run(1);
+        QCOMPARE(lcd->busExtractions(), extractions + 2);
+    }
+
+    void snapshot_restores_state()
+    {
+        loadRom({
+            0xE8,             // inx
+            0x8E, 0x00, 0x02, // stx $0200
+            0x4C, 0x00, 0x80, // jmp $8000
+        });
+
+        board->run(500);
+        const auto snapshot = board->saveSnapshot();
+        QVERIFY(snapshot.isValid());
+        const auto x = board->cpu()->registerX();
+        const auto pc = board->cpu()->registerPC();
+        const auto stored = ram->byte(0x0200);
+
+        board->run(300);
+        QVERIFY(board->cpu()->registerX() != x);
+
+        QVERIFY(board->restoreSnapshot(snapshot));
+        QCOMPARE(board->cycleCount(), uint64_t{500});
+        QCOMPARE(board->cpu()->registerX(), x);
+        QCOMPARE(board->cpu()->registerPC(), pc);
+        QCOMPARE(ram->byte(0x0200), stored);
+
+        // continues exactly like before
+        board->run(300);
+        const auto xAfter = board->cpu()->registerX();
+        QVERIFY(board->restoreSnapshot(snapshot));
+        board->run(300);
+        QCOMPARE(board->cpu()->registerX(), xAfter);
+    }
+
+    void snapshot_rejects_other_board()
+    {
+        const auto snapshot = board->saveSnapshot();
+
+        cleanup();
+        init();
+        board->reset({new Memory{Memory::Type::RAM, 0x100, QStringLiteral("OTHER"), board}}, {});
+
+        QVERIFY(!board->restoreSnapshot(snapshot));
+        QVERIFY(!board->restoreSnapshot(BoardSnapshot{}));
+
+        // same devices, but a smaller ram
+        cleanup();
+        board = new Board{};
+        ram = new Memory{Memory::Type::RAM, 0x4000, QStringLiteral("RAM"), board};
+        rom = new Memory{Memory::Type::ROM, 0x8000, QStringLiteral("ROM"), board};
+        rom->setMapAddressStart(0x8000);
+        board->reset({ram, rom}, {});
+        ram->data()[0] = 0x42;
+
+        QVERIFY(!board->restoreSnapshot(snapshot));
+        QCOMPARE(ram->byte(0), uint8_t{0x42});
+        QCOMPARE(ram->data().size(), 0x4000);
+    }
+
+    void snapshot_restores_via()
+    {
+        const QVector<uint8_t> program{
+            0xA9, 0x40,       // lda #$40
+            0x8D, 0x0B, 0x60, // sta $600B ; t1 free running
+            0xA9, 0x23,       // lda #$23
+            0x8D, 0x04, 0x60, // sta $6004
+            0xA9, 0x01,       // lda #$01
+            0x8D, 0x05, 0x60, // sta $6005
+            0xA9, 0xC0,       // lda #$C0
+            0x8D, 0x0E, 0x60, // sta $600E ; enable t1 interrupt
+            0x58,             // cli
+            0x4C, 0x15, 0x80, // jmp $8015
+            0xEE, 0x00, 0x02, // inc $0200 ; irq handler
+            0xAD, 0x04, 0x60, // lda $6004
+            0x8D, 0x01, 0x02, // sta $0201
+            0x40,             // rti
+        };
+
+        buildViaBoard(program, false);
+        board->run(1000);
+        const auto snapshot = board->saveSnapshot();
+        board->run(5000);
+        const auto ramData = ram->data();
+        QVERIFY(ramData[0x0200] > 5);
+
+        QVERIFY(board->restoreSnapshot(snapshot));
+        board->run(5000);
+        QCOMPARE(ram->data(), ramData);
+    }
+
+    void seek_rewinds_history()
+    {
+        loadRom({
+            0xE8,             // inx
+            0x8E, 0x00, 0x02, // stx $0200
+            0x4C, 0x00, 0x80, // jmp $8000
+        });
+
+        board->setHistoryEnabled(true);
+        board->history().setCheckpointInterval(100);
+
+        board->run(550);
+        const auto x = board->cpu()->registerX();
+        const auto pc = board->cpu()->registerPC();
+        const auto stored = ram->byte(0x0200);
+
+        board->run(1000);
+        QVERIFY(board->history().checkpointCount() > 1);
+        QVERIFY(board->cpu()->registerX() != x);
+
+        QVERIFY(board->seek(550));
+        QCOMPARE(board->cycleCount(), uint64_t{550});
+        QCOMPARE(board->cpu()->registerX(), x);
+        QCOMPARE(board->cpu()->registerPC(), pc);
+        QCOMPARE(ram->byte(0x0200), stored);
+
+        // the dropped part of the history is recorded again
+        QVERIFY(board->seek(1200));
+        QVERIFY(board->seek(550));
+        QCOMPARE(board->cpu()->registerX(), x);
+        QCOMPARE(ram->byte(0x0200), stored);
+
+        board->history().setBudget(0);
+        QCOMPARE(board->history().checkpointCount(), 1);
+        QVERIFY(!board->seek(0));
+    }
+
+    void reverse_continue_with_small_history()
+    {
+        loadRom({
+            0xA2, 0x00,       // ldx #$00
+            0xE8,             // inx
+            0xD0, 0xFD,       // bne $8002
+            0xEE, 0x00, 0x02, // inc $0200
+            0x4C, 0x02, 0x80, // jmp $8002
+        });
+
+        auto* debugger = board->debugger();
+        auto& history = board->history();
+        board->setHistoryEnabled(true);
+        history.setCheckpointInterval(100);
+        debugger->addBreakpoint(0x8005);
+
+        QVector<uint64_t> hits;
+        for (int i = 0; i < 4; ++i)
+        {
+            board->run(100000);
+            hits.append(board->cycleCount());
+        }
+
+        debugger->removeBreakpoint(0x8005);
+        board->run(500);
+        debugger->addBreakpoint(0x8005);
+        QCOMPARE(ram->byte(0x0200), uint8_t{4});
+
+        // about 3000 cycles of history, so replays prune the oldest checkpoints while searching
+        history.setBudget(history.size() / history.checkpointCount() * 30);
+        QVERIFY(history.checkpointCycle(0) < hits[2]);
+
+        debugger->reverseContinue();
+        QCOMPARE(board->cycleCount(), hits[3]);
+        QCOMPARE(ram->byte(0x0200), uint8_t{3});
+
+        debugger->reverseContinue();
+        QCOMPARE(board->cycleCount(), hits[2]);
+        QCOMPARE(ram->byte(0x0200), uint8_t{2});
+    }
+
+    void sleeping_via_matches_ticked_via()
+    {
+        const QVector<uint8_t> program{
+            0xA9, 0x40,       // lda #$40
+            0x8D, 0x0B, 0x60, // sta $600B ; t1 free running
+            0xA9, 0xFF,       // lda #$FF
+            0x8D, 0x04, 0x60, // sta $6004
+            0xA9, 0x10,       // lda #$10
+            0x8D, 0x05, 0x60, // sta $6005
+            0xA9, 0xC0,       // lda #$C0
+            0x8D, 0x0E, 0x60, // sta $600E ; enable t1 interrupt
+            0x58,             // cli
+            0x4C, 0x15, 0x80, // jmp $8015
+            0xEE, 0x00, 0x02, // inc $0200 ; irq handler
+            0xAD, 0x04, 0x60, // lda $6004
+            0x8D, 0x01, 0x02, // sta $0201
+            0x40,             // rti
+        };
+
+        const auto ticked = runViaProgram(program, true);
+        const auto slept = runViaProgram(program, false);
+        QVERIFY(ticked[0x0200] > 5);
+        QCOMPARE(slept, ticked);
+    }
+
+    void sleeping_via_timers_read_back()
+    {
+        const QVector<uint8_t> program{
+            0xA9, 0x40,       // lda #$40
+            0x8D, 0x0B, 0x60, // sta $600B ; t1 free running, no interrupts
+            0xA9, 0x34,       // lda #$34
+            0x8D, 0x04, 0x60, // sta $6004
+            0xA9, 0x02,       // lda #$02
+            0x8D, 0x05, 0x60, // sta $6005
+            0x8D, 0x09, 0x60, // sta $6009 ; t2 one shot
+            0xA2, 0x00,       // ldx #$00
+            0xA0, 0x00,       // ldy #$00 ; delay
+            0x88,             // dey
+            0xD0, 0xFD,       // bne $8016
+            0xAD, 0x04, 0x60, // lda $6004
+            0x9D, 0x00, 0x02, // sta $0200,x
+            0xAD, 0x08, 0x60, // lda $6008
+            0x9D, 0x00, 0x03, // sta $0300,x
+            0xAD, 0x0D, 0x60, // lda $600D
+            0x9D, 0x00, 0x04, // sta $0400,x
+            0xE8,             // inx
+            0x4C, 0x14, 0x80, // jmp $8014
+        };
+
+        QCOMPARE(runViaProgram(program, false), runViaProgram(program, true));
+    }
+
+    void static_dispatch_matches_generic_dispatch()
+    {
+        const QVector<uint8_t> program{
+            0xA9, 0x40,       // lda #$40
+            0x8D, 0x0B, 0x60, // sta $600B ; t1 free running
+            0xA9, 0xFF,       // lda #$FF
+            0x8D, 0x04, 0x60, // sta $6004
+            0xA9, 0x10,       // lda #$10
+            0x8D, 0x05, 0x60, // sta $6005
+            0xA9, 0xC0,       // lda #$C0
+            0x8D, 0x0E, 0x60, // sta $600E ; enable t1 interrupt
+            0x58,             // cli
+            0x4C, 0x15, 0x80, // jmp $8015
+            0xEE, 0x00, 0x02, // inc $0200 ; irq handler
+            0xAD, 0x04, 0x60, // lda $6004
+            0x8D, 0x01, 0x02, // sta $0201
+            0x40,             // rti
+        };
+
+        const auto dispatched = runViaProgram(program, false, true);
+        QVERIFY(board->isStaticDispatch());
+        QVERIFY(dispatched[0x0200] > 5);
+        QCOMPARE(dispatched, runViaProgram(program, false));
+
+        // a board with other devices keeps the generic dispatch
+        board->setDispatch(new StaticBoard<StaticDevice<VIA, 0x7000, 0x700F, true>>{});
+        QVERIFY(!board->isStaticDispatch());
+    }
+
+    void input_log_replays_inputs()
+    {
+        const QVector<uint8_t> program{
+            0xA2, 0x00,       // ldx #$00
+            0xAD, 0x01, 0x60, // lda $6001
+            0x9D, 0x00, 0x02, // sta $0200,x
+            0xE8,             // inx
+            0x4C, 0x02, 0x80, // jmp $8002
+        };
+
+        const auto run = [this, &program](const QVector<InputLog::Input>* replay) {
+            buildBoard(ViaIo);
+            board->setInstructionStepping(true);
+            loadRom(program);
+
+            if (replay)
+            {
+                board->inputLog().startReplay(*replay, board->cycleCount());
+                board->run(3000);
+            }
+            else
+            {
+                board->inputLog().startRecording(board->cycleCount());
+                board->run(501);
+                board->postInput(via, VIA::PaInput, 0x11);
+                board->run(777);
+                board->postInput(via, VIA::PaInput, 0x22);
+                board->postInput(nullptr, Board::ResetInput, 1);
+                board->run(3000 - 501 - 777);
+            }
+
+            return ram->data();
+        };
+
+        const auto recorded = run(nullptr);
+        const auto inputs = board->inputLog().inputs();
+        QCOMPARE(inputs.size(), 3);
+        QCOMPARE(inputs.at(1).cycle - inputs.at(0).cycle, uint64_t{777});
+        QCOMPARE(inputs.at(2).device, -1);
+
+        QVector<InputLog::Input> decoded;
+        QVERIFY(InputLog::decode(InputLog::encode(inputs), decoded));
+        QCOMPARE(decoded.size(), inputs.size());
+        for (int i = 0; i < inputs.size(); ++i)
+        {
+            QCOMPARE(decoded.at(i).cycle, inputs.at(i).cycle);
+            QCOMPARE(decoded.at(i).device, inputs.at(i).device);
+            QCOMPARE(decoded.at(i).channel, inputs.at(i).channel);
+            QCOMPARE(decoded.at(i).value, inputs.at(i).value);
+        }
+
+        QVERIFY(recorded.contains(0x11));
+        QCOMPARE(run(&decoded), recorded);
+    }
+
+    void acia_counts_baud_in_cycles()
+    {
+        buildBoard(AciaIo);
+
+        loadRom({
+            0xA9, 0x1F,       // lda #$1F ; 19200 baud, 8N1
+            0x8D, 0x03, 0x70, // sta $7003
+            0xA9, 0x0B,       // lda #$0B
+            0x8D, 0x02, 0x70, // sta $7002
+            0xA9, 0x41,       // lda #$41
+            0x8D, 0x00, 0x70, // sta $7000
+            0x4C, 0x0F, 0x80, // jmp $800F
+        });
+
+        QVector<uint8_t> sent;
+        connect(acia, &ACIA::sendByte, this, [&sent](uint8_t byte) { sent.append(byte); });
+
+        // 10 bits at 1MHz / 19200 baud take 521 cycles
+        board->run(500);
+        QVERIFY(acia->isTransmitting());
+        QVERIFY(sent.isEmpty());
+        board->run(100);
+        QVERIFY(!acia->isTransmitting());
+        QCOMPARE(sent, QVector<uint8_t>{0x41});
+
+        acia->receiveByte(0x5A);
+        board->run(520);
+        QVERIFY(!(acia->statusRegister() & ACIA::ReceiverFull));
+        board->run(1);
+        QVERIFY(acia->statusRegister() & ACIA::ReceiverFull);
+        QCOMPARE(acia->receiverBuffer(), uint8_t{0x5A});
+    }
+
+    void run_small_slices()
+    {
+        loadRom({
+            0xE8,             // inx
+            0x4C, 0x00, 0x80, // jmp $8000
+        });
+
+        board->setRunSliceCycles(7);
+        QCOMPARE(board->run(1000), uint64_t{1000});
+        QCOMPARE(board->cycleCount(), uint64_t{1000});
+    }
+
+    void run_until_predicate()
+    {
+        loadRom({
+            0xE8,             // inx
+            0x4C, 0x00, 0x80, // jmp $8000
+        });
+
+        auto executed = board->runUntil([this]() { return board->cpu()->registerX() == 10; }, 100000);
+        QVERIFY(executed < 100000);
+        QCOMPARE(board->cpu()->registerX(), uint64_t{10});
+    }
+};
+
+#include "test_Board.moc"
+QTEST_MAIN(TestBoard)
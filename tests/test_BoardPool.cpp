@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BoardPool.h"
+#include "board/Board.h"
+#include "board/CPU.h"
+#include "board/Memory.h"
+#include <QtTest>
+
+class TestBoardPool : public QObject
+{
+    Q_OBJECT
+
+private:
+    BoardInfo boardInfo()
+    {
+        BoardInfo info;
+        info.devices.append(MemoryInfo{{DeviceType::Memory, QStringLiteral("RAM"), 0x0000, {}},
+                                       Memory::Type::RAM, 0x8000});
+        info.devices.append(MemoryInfo{{DeviceType::Memory, QStringLiteral("ROM"), 0x8000, {}},
+                                       Memory::Type::ROM, 0x8000});
+        return info;
+    }
+
+    static void loadCounter(Board* board)
+    {
+        auto* rom = board->findDevice<Memory>(0x8000);
+        const QVector<uint8_t> program{
+            0xE6, 0x10,       // inc $10
+            0x4C, 0x00, 0x80, // jmp $8000
+        };
+        for (int i = 0; i < program.size(); ++i)
+            rom->data()[i] = program[i];
+
+        // reset vector -> 0x8000
+        rom->data()[0x7FFC] = 0x00;
+        rom->data()[0x7FFD] = 0x80;
+    }
+
+private slots:
+    void run_collects_results_in_job_order()
+    {
+        QVector<BoardJob> jobs;
+        for (int i = 0; i < 16; ++i)
+        {
+            BoardJob job;
+            job.name = QString::number(i);
+            job.maxCycles = 1000 + static_cast<uint64_t>(i);
+            job.setup = &TestBoardPool::loadCounter;
+            jobs.append(job);
+        }
+
+        BoardPool pool{boardInfo()};
+        pool.setMaxThreadCount(4);
+        const auto results = pool.run(jobs);
+
+        QCOMPARE(results.size(), jobs.size());
+        for (int i = 0; i < results.size(); ++i)
+        {
+            QCOMPARE(results[i].name, jobs[i].name);
+            QCOMPARE(results[i].exit, BoardResult::Exit::CycleLimit);
+            QCOMPARE(results[i].cycles, jobs[i].maxCycles);
+        }
+    }
+
+    void run_stops_at_condition()
+    {
+        BoardJob job;
+        job.maxCycles = 100000;
+        job.setup = &TestBoardPool::loadCounter;
+        job.stopCondition = [](const Board* board) {
+            return qobject_cast<const Memory*>(board->devices().first())->byte(0x10) == 100;
+        };
+
+        BoardPool pool{boardInfo()};
+        const auto results = pool.run({job});
+
+        QCOMPARE(results.first().exit, BoardResult::Exit::Condition);
+        QVERIFY(results.first().cycles < job.maxCycles);
+    }
+
+    void run_reports_missing_program_memory()
+    {
+        BoardJob job;
+        job.programFileName = QStringLiteral("program.bin");
+        job.programMemory = QStringLiteral("FLASH");
+        job.maxCycles = 100;
+
+        BoardPool pool{boardInfo()};
+        const auto results = pool.run({job});
+
+        QCOMPARE(results.first().exit, BoardResult::Exit::LoadFailed);
+        QCOMPARE(results.first().cycles, uint64_t{0});
+    }
+};
+
+#include "test_BoardPool.moc"
+QTEST_MAIN(TestBoardPool)
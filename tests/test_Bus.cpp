@@ -12,8 +12,18 @@
  */
 
 #include "board/Bus.h"
+#include "board/BusConnection.h"
+#include "LooseSignal.h"
 #include <QtTest>
 
+class Listener : public QObject
+{
+public:
+    void onDataChanged() { ++changes; }
+
+    int changes = 0;
+};
+
 class TestBus : public QObject
 {
     Q_OBJECT
@@ -58,6 +68,67 @@ private slots:
         QCOMPARE(bus->bit(4), WireState::Low);
         QCOMPARE(bus->data(), 0b01100000);
     }
+
+    void data_changed_only_when_observed()
+    {
+#ifdef EMU_HEADLESS
+        QSKIP("state change signals are compiled out");
+#endif
+        int changes = 0;
+        bus->setData(0x12);
+
+        auto connection = connect(bus, &Bus::dataChanged, this, [&changes]() { ++changes; });
+        bus->setData(0x34);
+        QCOMPARE(changes, 1);
+
+        disconnect(connection);
+        bus->setData(0x56);
+        QCOMPARE(changes, 1);
+        QCOMPARE(bus->data(), 0x56);
+    }
+
+    void loose_signal_released_with_receiver()
+    {
+#ifdef EMU_HEADLESS
+        QSKIP("state change signals are compiled out");
+#endif
+        auto* listener = new Listener;
+        LooseSignal::connect(bus, &Bus::dataChanged, listener, &Listener::onDataChanged);
+        QVERIFY(bus->isObserved());
+
+        bus->setData(0x12);
+        bus->setData(0x34);
+        QCoreApplication::processEvents();
+        QCOMPARE(listener->changes, 1);
+
+        delete listener;
+        QVERIFY(!bus->isObserved());
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        QVERIFY(bus->children().isEmpty());
+    }
+
+    void generation_counts_changes()
+    {
+        BusConnection connection{0, 0xFF, bus, 0xFF};
+        QVERIFY(connection.takeChange());
+        QVERIFY(!connection.takeChange());
+
+        const auto generation = bus->generation();
+        bus->setData(0x00);
+        bus->setBit(3, WireState::Low);
+        bus->setMaskedData(0x00, 0xF0);
+        QCOMPARE(bus->generation(), generation);
+        QVERIFY(!connection.takeChange());
+
+        bus->setBit(3, WireState::High);
+        bus->setData(0x12);
+        QCOMPARE(bus->generation(), generation + 2);
+        QVERIFY(connection.takeChange());
+        QVERIFY(!connection.takeChange());
+
+        connection.invalidate();
+        QVERIFY(connection.takeChange());
+    }
 };
 
 #include "test_Bus.moc"
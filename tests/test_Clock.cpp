@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2023 Daniel Volk <mail@volkarts.com>
+ *
+ * This file is part of 6502emu - 6502 cycle accurate emulator gui.
+ *
+ * 6502emu is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with 6502emu. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "board/Clock.h"
+#include <QElapsedTimer>
+#include <QtTest>
+
+class TestClock : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void default_frequency_drives_edges()
+    {
+        Clock clock;
+        uint64_t batched = 0;
+        clock.setCycleRunner([&batched](uint64_t cycles) {
+            batched += cycles;
+            return cycles;
+        });
+        QCOMPARE(clock.frequency(), 1000.0);
+
+        QSignalSpy edges{&clock, &Clock::clockCycleChanged};
+        QElapsedTimer timer;
+        timer.start();
+        clock.start();
+        QTest::qWait(500);
+        const auto elapsed = timer.nsecsElapsed();
+        const auto count = edges.count();
+        clock.stop();
+        QTRY_VERIFY(!clock.isRunning());
+
+        QCOMPARE(batched, uint64_t{0});
+
+        // two edges per cycle on absolute deadlines, the first one right at the start; never
+        // ahead and only behind by the timer resolution
+        const double expected = static_cast<double>(elapsed) * 2.0 * clock.frequency() / 1e9;
+        const auto message = QStringLiteral("%1 edges for %2").arg(count).arg(expected).toUtf8();
+        QVERIFY2(count <= expected + 1.0, message.constData());
+        QVERIFY2(count >= expected * 0.95 - 4.0, message.constData());
+    }
+
+    void batches_keep_pace()
+    {
+        constexpr double frequency = 400000.0;
+        constexpr uint64_t cycles = 200000;
+        // a batch covers 1 ms, the one reaching the cycles runs before its sleep
+        constexpr double batchNs = 1000000.0;
+
+        Clock clock;
+        clock.setFrequency(frequency);
+
+        QElapsedTimer timer;
+        uint64_t executed = 0;
+        qint64 elapsed = 0;
+        clock.setCycleRunner([&](uint64_t batch) {
+            executed += batch;
+            if (executed >= cycles && elapsed == 0)
+            {
+                elapsed = timer.nsecsElapsed();
+                clock.stop();
+            }
+            return batch;
+        });
+
+        timer.start();
+        clock.start();
+        QTRY_VERIFY_WITH_TIMEOUT(!clock.isRunning(), 5000);
+
+        // absolute deadlines never run ahead and only fall behind by the scheduling delay
+        const double expected = static_cast<double>(cycles) / frequency * 1e9;
+        const auto message = QStringLiteral("%1 ns for %2 ns").arg(elapsed).arg(expected).toUtf8();
+        QVERIFY2(static_cast<double>(elapsed) >= expected - batchNs * 1.1, message.constData());
+        QVERIFY2(static_cast<double>(elapsed) <= expected * 1.05, message.constData());
+    }
+};
+
+#include "test_Clock.moc"
+QTEST_MAIN(TestClock)